@@ -0,0 +1,185 @@
+#include "can_dispatch.h"
+#include <string.h>
+
+#define CAN_DISPATCH_HASH_MASK (CAN_DISPATCH_HASH_SIZE - 1)
+
+/* Multiplicative (Fibonacci) hash of a CAN ID */
+static inline uint32_t can_dispatch_hash(uint32_t id) {
+    return (id * 0x9E3779B1u) >> (32 - CAN_DISPATCH_HASH_BITS);
+}
+
+/*
+ * Initialize a dispatch table
+ * - Clears entries, lookup structures and statistics
+ */
+void can_dispatch_init(CanDispatch *d) {
+    memset(d, 0, sizeof(*d));
+}
+
+/* True if an entry with exactly this ID/mask pair is already registered */
+static bool can_dispatch_has_entry(const CanDispatch *d, uint32_t id, uint32_t mask) {
+    for (uint16_t i = 0; i < d->num_entries; i++) {
+        if (d->entries[i].mask == mask && d->entries[i].id == (id & mask)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Add an entry to the table
+ * - ID/mask pairs must be unique; the lookup is rebuilt by can_dispatch_build()
+ */
+static bool can_dispatch_add(CanDispatch *d, uint32_t id, uint32_t mask,
+                             CanHandler handler, void *ctx, QueueHandle_t queue) {
+    CanDispatchEntry *e;
+
+    if (d->num_entries >= CAN_DISPATCH_MAX_ENTRIES) {
+        return false;
+    }
+    if (can_dispatch_has_entry(d, id, mask)) {
+        return false;
+    }
+
+    e = &d->entries[d->num_entries++];
+    e->id = id & mask;
+    e->mask = mask;
+    e->handler = handler;
+    e->ctx = ctx;
+    e->queue = queue;
+    e->hits = 0;
+
+    d->built = false;
+    return true;
+}
+
+bool can_dispatch_register(CanDispatch *d, uint32_t id, CanHandler handler, void *ctx) {
+    return can_dispatch_add(d, id, CAN_ID_MASK_EXACT, handler, ctx, NULL);
+}
+
+bool can_dispatch_register_range(CanDispatch *d, uint32_t base, uint32_t mask,
+                                 CanHandler handler, void *ctx) {
+    return can_dispatch_add(d, base, mask, handler, ctx, NULL);
+}
+
+bool can_dispatch_register_queue(CanDispatch *d, uint32_t base, uint32_t mask,
+                                 QueueHandle_t queue) {
+    return can_dispatch_add(d, base, mask, NULL, NULL, queue);
+}
+
+/*
+ * Build the lookup structures
+ * - Exact IDs go to the hash table (linear probing)
+ * - Ranges are sorted by number of mask bits, so the most specific wins
+ */
+void can_dispatch_build(CanDispatch *d) {
+    memset(d->hash, 0, sizeof(d->hash));
+    d->num_ranges = 0;
+
+    for (uint16_t i = 0; i < d->num_entries; i++) {
+        const CanDispatchEntry *e = &d->entries[i];
+
+        if (e->mask == CAN_ID_MASK_EXACT) {
+            uint32_t slot = can_dispatch_hash(e->id);
+
+            while (d->hash[slot] != 0) {
+                slot = (slot + 1) & CAN_DISPATCH_HASH_MASK;
+            }
+            d->hash[slot] = i + 1;
+        } else {
+            /* Insertion sort: few ranges, done once at init */
+            int pos = d->num_ranges++;
+            int bits = __builtin_popcount(e->mask);
+
+            while (pos > 0 &&
+                   __builtin_popcount(d->entries[d->ranges[pos - 1]].mask) < bits) {
+                d->ranges[pos] = d->ranges[pos - 1];
+                pos--;
+            }
+            d->ranges[pos] = i;
+        }
+    }
+
+    d->built = true;
+}
+
+/*
+ * Find the entry for a CAN ID
+ * - Hash probe for exact IDs, then the sorted range list
+ * - Before can_dispatch_build() falls back to a linear scan with the same
+ *   precedence: most mask bits first, then registration order
+ */
+const CanDispatchEntry *can_dispatch_lookup(const CanDispatch *d, uint32_t id) {
+    if (!d->built) {
+        const CanDispatchEntry *best = NULL;
+        int best_bits = -1;
+
+        for (uint16_t i = 0; i < d->num_entries; i++) {
+            const CanDispatchEntry *e = &d->entries[i];
+            int bits = __builtin_popcount(e->mask);
+
+            if ((id & e->mask) == e->id && bits > best_bits) {
+                best = e;
+                best_bits = bits;
+            }
+        }
+        return best;
+    }
+
+    for (uint32_t slot = can_dispatch_hash(id); d->hash[slot] != 0;
+         slot = (slot + 1) & CAN_DISPATCH_HASH_MASK) {
+        const CanDispatchEntry *e = &d->entries[d->hash[slot] - 1];
+
+        if (e->id == id) {
+            return e;
+        }
+    }
+
+    for (uint16_t i = 0; i < d->num_ranges; i++) {
+        const CanDispatchEntry *e = &d->entries[d->ranges[i]];
+
+        if ((id & e->mask) == e->id) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Dispatch a frame to its handler and/or queue
+ * - Queues are posted without blocking; a full queue is counted
+ * - Unmatched frames update the unhandled statistics
+ * - Counters are updated atomically: frames may arrive from several ISRs and tasks
+ */
+bool can_dispatch_frame(CanDispatch *d, const CanFrame *frame) {
+    CanDispatchEntry *e = (CanDispatchEntry *)can_dispatch_lookup(d, frame->id);
+
+    if (e == NULL) {
+        __atomic_fetch_add(&d->unhandled, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&d->last_unhandled_id, frame->id, __ATOMIC_RELAXED);
+        return false;
+    }
+
+    __atomic_fetch_add(&e->hits, 1, __ATOMIC_RELAXED);
+
+    if (e->handler) {
+        e->handler(frame, e->ctx);
+    }
+
+    if (e->queue) {
+        BaseType_t ok;
+
+        if (xPortIsInsideInterrupt()) {
+            BaseType_t woken = pdFALSE;
+            ok = xQueueSendFromISR(e->queue, frame, &woken);
+            portYIELD_FROM_ISR(woken);
+        } else {
+            ok = xQueueSend(e->queue, frame, 0);
+        }
+
+        if (ok != pdPASS) {
+            __atomic_fetch_add(&d->queue_full, 1, __ATOMIC_RELAXED);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef CAN_DISPATCH_H
+#define CAN_DISPATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "queue.h"
+#include "flexcan.h"
+
+/* Maximum number of handlers (exact IDs + ranges) per dispatch table */
+#ifndef CAN_DISPATCH_MAX_ENTRIES
+#define CAN_DISPATCH_MAX_ENTRIES 384
+#endif
+
+/* log2 of the ID hash table size (keep the load factor below 1/2) */
+#ifndef CAN_DISPATCH_HASH_BITS
+#define CAN_DISPATCH_HASH_BITS 10
+#endif
+
+#define CAN_DISPATCH_HASH_SIZE (1u << CAN_DISPATCH_HASH_BITS)
+
+/* Mask value of an entry matching a single CAN ID */
+#define CAN_ID_MASK_EXACT 0xFFFFFFFFu
+
+/* Handler called for a matching frame, with the context given at registration */
+typedef void (*CanHandler)(const CanFrame *frame, void *ctx);
+
+/*
+ * Dispatch entry
+ * - Matches frames with (frame->id & mask) == id
+ * - Calls 'handler' and/or posts a copy of the frame to 'queue'
+ */
+typedef struct CanDispatchEntry {
+    uint32_t id;
+    uint32_t mask;
+    CanHandler handler;   /* Optional handler */
+    void *ctx;            /* Handler context */
+    QueueHandle_t queue;  /* Optional queue of CanFrame */
+    uint32_t hits;        /* Frames dispatched to this entry */
+} CanDispatchEntry;
+
+/*
+ * CAN ID dispatch table
+ * - Exact IDs are resolved in O(1) through an open-addressing hash table
+ * - ID/mask ranges are checked afterwards, most specific mask first
+ * - Entries are registered at init, then can_dispatch_build() prepares the lookup
+ */
+typedef struct CanDispatch {
+    CanDispatchEntry entries[CAN_DISPATCH_MAX_ENTRIES];
+    uint16_t num_entries;
+
+    uint16_t hash[CAN_DISPATCH_HASH_SIZE];   /* Entry index + 1 of exact IDs, 0 = empty */
+    uint16_t ranges[CAN_DISPATCH_MAX_ENTRIES]; /* Entry indices of ID/mask ranges */
+    uint16_t num_ranges;
+    bool built;
+
+    /* Statistics */
+    uint32_t unhandled;         /* Frames matching no entry */
+    uint32_t last_unhandled_id; /* ID of the last unhandled frame */
+    uint32_t queue_full;        /* Frames dropped because a queue was full */
+} CanDispatch;
+
+/* Function prototypes */
+
+/* Initialize an empty dispatch table */
+void can_dispatch_init(CanDispatch *d);
+
+/* Register a handler for a single CAN ID (fails on duplicates or when full) */
+bool can_dispatch_register(CanDispatch *d, uint32_t id, CanHandler handler, void *ctx);
+
+/* Register a handler for all IDs with (id & mask) == (base & mask) */
+bool can_dispatch_register_range(CanDispatch *d, uint32_t base, uint32_t mask,
+                                 CanHandler handler, void *ctx);
+
+/* Post frames matching (id & mask) == (base & mask) to a queue of CanFrame */
+bool can_dispatch_register_queue(CanDispatch *d, uint32_t base, uint32_t mask,
+                                 QueueHandle_t queue);
+
+/* Build the lookup structures; must be called after the last registration */
+void can_dispatch_build(CanDispatch *d);
+
+/* Dispatch a frame; returns false if no entry matched (ISR-safe) */
+bool can_dispatch_frame(CanDispatch *d, const CanFrame *frame);
+
+/* Find the entry handling a CAN ID, or NULL */
+const CanDispatchEntry *can_dispatch_lookup(const CanDispatch *d, uint32_t id);
+
+#endif /* CAN_DISPATCH_H */
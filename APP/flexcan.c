@@ -1,22 +1,28 @@
 #include "flexcan.h"
 #include "lpuart.h"
 #include <string.h>
-#include "semphr.h"
+
+#define RX_BUFFER_MASK (RX_BUFFER_SIZE - 1)
+
+#if (RX_BUFFER_SIZE & RX_BUFFER_MASK) != 0
+#error "RX_BUFFER_SIZE must be a power of two"
+#endif
 
 /*
  * Initialize a FlexCAN peripheral instance
  * - Clears the bus pointer
  * - Clears receive callback
- * - Initializes the circular RX buffer and mutex
+ * - Initializes the RX ring, its overflow counter and the consumer task
  */
 void flexcan_init(FlexCANState *s) {
     s->bus = NULL;
     s->receive_callback = NULL;
 
-    /* Circular RX buffer initialization */
+    /* RX ring initialization */
     s->rx_head = 0;
     s->rx_tail = 0;
-    s->rx_mutex = xSemaphoreCreateMutex();  /* FreeRTOS mutex to protect buffer access */
+    s->rx_overflows = 0;
+    s->rx_task = NULL;
 }
 
 /*
@@ -39,10 +45,41 @@ void can_bus_add_node(CanBus *bus, FlexCANState *node) {
     }
 }
 
+/*
+ * Store a frame in a node's RX ring
+ * - Lock-free: the slot is filled first, then the new head is published
+ *   with release ordering, so the consumer never sees a partial frame
+ * - A full ring keeps the unread frames; the new one is dropped and counted
+ * - Wakes the consumer task, if any, through a direct task notification
+ * - Callable from ISR context; at most one producer per node
+ */
+bool flexcan_rx_push(FlexCANState *node, const CanFrame *frame) {
+    uint32_t head = node->rx_head;
+
+    if (head - __atomic_load_n(&node->rx_tail, __ATOMIC_ACQUIRE) >= RX_BUFFER_SIZE) {
+        node->rx_overflows++;
+        return false;
+    }
+
+    node->rx_buffer[head & RX_BUFFER_MASK] = *frame;
+    __atomic_store_n(&node->rx_head, head + 1, __ATOMIC_RELEASE);
+
+    if (node->rx_task != NULL) {
+        if (xPortIsInsideInterrupt()) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(node->rx_task, &woken);
+            portYIELD_FROM_ISR(woken);
+        } else {
+            xTaskNotifyGive(node->rx_task);
+        }
+    }
+    return true;
+}
+
 /*
  * Transmit a CAN frame on the logical bus
  * - Frame is delivered to all nodes except the sender
- * - Each receiver inserts the frame into its circular RX buffer
+ * - Each receiver inserts the frame into its RX ring
  * - Optional callback is called after insertion
  */
 void can_bus_transmit(CanBus *bus, FlexCANState *sender, CanFrame *frame) {
@@ -50,12 +87,8 @@ void can_bus_transmit(CanBus *bus, FlexCANState *sender, CanFrame *frame) {
         if (bus->nodes[i] != sender && bus->nodes[i] != NULL) {
             FlexCANState *receiver = bus->nodes[i];
 
-            /* Insert frame into the circular buffer (thread-safe) */
-            if (xSemaphoreTake(receiver->rx_mutex, portMAX_DELAY) == pdTRUE) {
-                receiver->rx_buffer[receiver->rx_head] = *frame;
-                receiver->rx_head = (receiver->rx_head + 1) % RX_BUFFER_SIZE;
-                xSemaphoreGive(receiver->rx_mutex);
-            }
+            /* Insert frame into the RX ring (lock-free) */
+            flexcan_rx_push(receiver, frame);
 
             /* Call receive callback if defined */
             if (receiver->receive_callback)
@@ -67,17 +100,57 @@ void can_bus_transmit(CanBus *bus, FlexCANState *sender, CanFrame *frame) {
 /*
  * Read a CAN frame from a FlexCAN node's RX buffer
  * - Returns true if a frame was available
- * - Uses mutex to ensure thread-safe access
+ * - Lock-free: the slot is copied out before the new tail is published,
+ *   so the producer never overwrites a frame being read
  */
 bool flexcan_receive(FlexCANState *node, CanFrame *frame) {
-    bool has_frame = false;
-    if (xSemaphoreTake(node->rx_mutex, portMAX_DELAY) == pdTRUE) {
-        if (node->rx_head != node->rx_tail) {
-            *frame = node->rx_buffer[node->rx_tail];
-            node->rx_tail = (node->rx_tail + 1) % RX_BUFFER_SIZE;
-            has_frame = true;
-        }
-        xSemaphoreGive(node->rx_mutex);
+    uint32_t tail = node->rx_tail;
+
+    if (tail == __atomic_load_n(&node->rx_head, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+
+    *frame = node->rx_buffer[tail & RX_BUFFER_MASK];
+    __atomic_store_n(&node->rx_tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+/*
+ * Register the task woken when a frame arrives
+ * - The task should consume frames with flexcan_wait_receive()
+ */
+void flexcan_set_rx_task(FlexCANState *node, TaskHandle_t task) {
+    node->rx_task = task;
+}
+
+/*
+ * Drain pending frames from a FlexCAN node's RX buffer
+ * - Copies up to 'max' frames and publishes the new tail once
+ */
+size_t flexcan_receive_batch(FlexCANState *node, CanFrame *frames, size_t max) {
+    uint32_t tail = node->rx_tail;
+    uint32_t head = __atomic_load_n(&node->rx_head, __ATOMIC_ACQUIRE);
+    size_t count = 0;
+
+    while (tail != head && count < max) {
+        frames[count++] = node->rx_buffer[tail & RX_BUFFER_MASK];
+        tail++;
+    }
+
+    __atomic_store_n(&node->rx_tail, tail, __ATOMIC_RELEASE);
+    return count;
+}
+
+/*
+ * Wait for frames on a FlexCAN node
+ * - Frames already pending are returned without blocking
+ * - Otherwise sleeps on the task notification set by flexcan_rx_push()
+ */
+size_t flexcan_wait_receive(FlexCANState *node, CanFrame *frames, size_t max, TickType_t timeout) {
+    size_t count = flexcan_receive_batch(node, frames, max);
+
+    if (count == 0 && ulTaskNotifyTake(pdTRUE, timeout) != 0) {
+        count = flexcan_receive_batch(node, frames, max);
     }
-    return has_frame;
+    return count;
 }
@@ -3,14 +3,17 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "FreeRTOS.h"
-#include "semphr.h"
+#include "task.h"
 
 /* Maximum number of FlexCAN nodes on a single logical CAN bus */
 #define MAX_CAN_NODES 2
 
-/* Size of the circular receive buffer per node */
+/* Size of the circular receive buffer per node (must be a power of two) */
+#ifndef RX_BUFFER_SIZE
 #define RX_BUFFER_SIZE 16
+#endif
 
 /*
  * CAN frame structure
@@ -41,8 +44,9 @@ typedef struct CanBus {
  * FlexCAN peripheral state
  * - Represents a single FlexCAN controller
  * - Holds pointer to logical CAN bus and optional receive callback
- * - Implements a circular RX buffer for incoming CAN frames
- * - Mutex protects concurrent access to the RX buffer
+ * - Implements a lock-free single-producer/single-consumer RX ring
+ *   (one bus delivery context writes, one task reads)
+ * - Optionally notifies a consumer task on every received frame
  */
 typedef struct FlexCANState {
     CanBus *bus;    /* Pointer to the shared logical CAN bus */
@@ -50,11 +54,12 @@ typedef struct FlexCANState {
     /* Callback function called on frame reception (optional) */
     void (*receive_callback)(struct FlexCANState *s, CanFrame *frame);
 
-    /* Circular RX buffer */
+    /* SPSC RX ring: free-running indices, masked on access */
     CanFrame rx_buffer[RX_BUFFER_SIZE];
-    uint8_t rx_head;   /* Head index for writing */
-    uint8_t rx_tail;   /* Tail index for reading */
-    SemaphoreHandle_t rx_mutex;  /* Mutex for thread-safe buffer access */
+    uint32_t rx_head;      /* Written only by the producer */
+    uint32_t rx_tail;      /* Written only by the consumer */
+    uint32_t rx_overflows; /* Frames dropped because the ring was full */
+    TaskHandle_t rx_task;  /* Task notified on reception (optional) */
 } FlexCANState;
 
 /* Function prototypes */
@@ -71,9 +76,24 @@ void can_bus_add_node(CanBus *bus, FlexCANState *node);
 /* Transmit a CAN frame on the bus to all nodes except the sender */
 void can_bus_transmit(CanBus *bus, FlexCANState *sender, CanFrame *frame);
 
-/* Read a CAN frame from the FlexCAN node's RX buffer */
+/* Store a received frame in the node's RX ring (ISR-safe, single producer) */
+bool flexcan_rx_push(FlexCANState *node, const CanFrame *frame);
+
+/* Read a CAN frame from the FlexCAN node's RX buffer (single consumer) */
 bool flexcan_receive(FlexCANState *node, CanFrame *frame);
 
+/* Set the task notified when a frame is stored in the node's RX ring */
+void flexcan_set_rx_task(FlexCANState *node, TaskHandle_t task);
+
+/* Read up to 'max' pending frames in one call; returns the number read */
+size_t flexcan_receive_batch(FlexCANState *node, CanFrame *frames, size_t max);
+
+/*
+ * Block until frames are pending (or 'timeout' expires), then read up to 'max'
+ * - Must be called by the task registered with flexcan_set_rx_task()
+ */
+size_t flexcan_wait_receive(FlexCANState *node, CanFrame *frames, size_t max, TickType_t timeout);
+
 #endif /* FLEXCAN_H */
 
 
@@ -0,0 +1,122 @@
+#include "log.h"
+#include "lpuart.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define LOG_RING_MASK (LOG_RING_SIZE - 1)
+
+#if (LOG_RING_SIZE & LOG_RING_MASK) != 0
+#error "LOG_RING_SIZE must be a power of two"
+#endif
+
+/* Encoded size of the largest record on the wire */
+#define LOG_WIRE_MAX (8 + 4 * LOG_MAX_ARGS)
+
+/*
+ * Log record slot
+ * - seq is written last: it equals (reservation index + 1) once the slot is complete
+ */
+typedef struct LogRecord {
+    uint32_t seq;
+    uint32_t tick;
+    uint16_t id;
+    uint8_t nargs;
+    uint32_t args[LOG_MAX_ARGS];
+} LogRecord;
+
+/*
+ * Lock-free multi-producer / single-consumer ring
+ * - Producers reserve a slot by advancing log_head with a CAS (LDREX/STREX)
+ * - log_task is the only consumer and advances log_tail
+ */
+static LogRecord log_ring[LOG_RING_SIZE];
+static uint32_t log_head;
+static uint32_t log_tail;
+static uint32_t log_drop_count;
+
+/*
+ * Append a record to the ring
+ * - No locks and no formatting: usable on ISR and CAN delivery paths
+ */
+void log_record(uint16_t id, uint8_t nargs, const uint32_t *args) {
+    uint32_t head = __atomic_load_n(&log_head, __ATOMIC_RELAXED);
+    LogRecord *rec;
+
+    /* Reserve a slot */
+    do {
+        if (head - __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE) >= LOG_RING_SIZE) {
+            __atomic_fetch_add(&log_drop_count, 1, __ATOMIC_RELAXED);
+            return;
+        }
+    } while (!__atomic_compare_exchange_n(&log_head, &head, head + 1, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    rec = &log_ring[head & LOG_RING_MASK];
+    rec->tick = xPortIsInsideInterrupt() ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+    rec->id = id;
+    rec->nargs = nargs;
+    memcpy(rec->args, args, nargs * sizeof(uint32_t));
+
+    /* Commit: publish the slot contents to the consumer */
+    __atomic_store_n(&rec->seq, head + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t log_dropped(void) {
+    return __atomic_load_n(&log_drop_count, __ATOMIC_RELAXED);
+}
+
+/* Store a 32-bit value in little-endian order */
+static uint8_t *log_put_u32(uint8_t *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+    return p + 4;
+}
+
+/*
+ * Encode the record at the tail of the ring in wire format
+ * - Returns the encoded length, 0 if the next record is not committed yet
+ */
+static size_t log_encode_next(uint8_t *buf) {
+    uint32_t tail = log_tail;
+    const LogRecord *rec = &log_ring[tail & LOG_RING_MASK];
+    uint8_t *p = buf;
+
+    if (__atomic_load_n(&rec->seq, __ATOMIC_ACQUIRE) != tail + 1) {
+        return 0;
+    }
+
+    *p++ = LOG_RECORD_MARKER;
+    *p++ = rec->nargs;
+    *p++ = rec->id;
+    *p++ = rec->id >> 8;
+    p = log_put_u32(p, rec->tick);
+    for (int i = 0; i < rec->nargs; i++) {
+        p = log_put_u32(p, rec->args[i]);
+    }
+    return p - buf;
+}
+
+/*
+ * Log shipping task
+ * - Moves committed records to the LPUART TX ring buffer
+ * - Keeps a record in the ring if the UART buffer is full and retries later
+ */
+void log_task(void *pvParameters) {
+    (void)pvParameters;
+    uint8_t buf[LOG_WIRE_MAX];
+
+    while (1) {
+        size_t len;
+
+        while ((len = log_encode_next(buf)) != 0 && lpuart_try_write(buf, len) == len) {
+            /* Release the slot to the producers */
+            __atomic_store_n(&log_tail, log_tail + 1, __ATOMIC_RELEASE);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(LOG_TASK_DELAY_MS));
+    }
+}
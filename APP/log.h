@@ -0,0 +1,59 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+
+/*
+ * Deferred binary logging
+ * - LOG() stores only a format-string ID and raw 32-bit arguments in a lock-free ring
+ * - The format strings live in the non-loaded .log_fmt ELF section (no flash cost)
+ * - log_task ships the records over LPUART; tools/log_decode.py rebuilds the text
+ *   from the ELF
+ */
+
+/* Maximum number of 32-bit arguments per record */
+#define LOG_MAX_ARGS 4
+
+/* Number of record slots in the log ring (must be a power of two) */
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 64
+#endif
+
+/* Period of the log shipping task when the ring is empty */
+#define LOG_TASK_DELAY_MS 10
+
+/*
+ * Wire format of a record on the UART stream (little-endian):
+ *   0xFF | nargs (u8) | id (u16) | tick (u32) | args (nargs x u32)
+ * The marker byte never appears in ASCII text, so records and my_printf
+ * output can share the same UART.
+ */
+#define LOG_RECORD_MARKER 0xFF
+
+/* Count the variadic arguments of LOG() (0 to 6, anything above 4 is rejected) */
+#define LOG_NARGS(...) LOG_NARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, n, ...) n
+
+/*
+ * Record a log message
+ * - 'fmt' must be a string literal (printf-style, integer conversions only)
+ * - Arguments are converted to uint32_t; no formatting happens on the target
+ * - Safe to call from tasks and from ISRs
+ */
+#define LOG(fmt, ...) do { \
+    static const char log_fmt_[] __attribute__((section(".log_fmt"), used)) = fmt; \
+    _Static_assert(LOG_NARGS(__VA_ARGS__) <= LOG_MAX_ARGS, "too many LOG() arguments"); \
+    log_record((uint16_t)(uintptr_t)log_fmt_, LOG_NARGS(__VA_ARGS__), \
+               &((const uint32_t[LOG_MAX_ARGS + 1]){ 0, ##__VA_ARGS__ })[1]); \
+} while (0)
+
+/* Append a record to the ring (drops it and counts if the ring is full) */
+void log_record(uint16_t id, uint8_t nargs, const uint32_t *args);
+
+/* Number of records dropped because the ring was full */
+uint32_t log_dropped(void);
+
+/* Low-priority task shipping records to the LPUART TX ring buffer */
+void log_task(void *pvParameters);
+
+#endif /* LOG_H */
@@ -1,11 +1,92 @@
 #include "lpuart.h"
+#include "nvic.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define LPUART_TX_MASK (LPUART_TX_BUFFER_SIZE - 1)
+
+#if (LPUART_TX_BUFFER_SIZE & LPUART_TX_MASK) != 0
+#error "LPUART_TX_BUFFER_SIZE must be a power of two"
+#endif
+
+/*
+ * TX ring buffer
+ * - tx_head/tx_tail are free-running counters, masked on access
+ * - Producers (tasks and ISRs) advance tx_head inside a short critical section
+ * - The LPUART0 TX interrupt is the only consumer and advances tx_tail
+ */
+static uint8_t tx_buffer[LPUART_TX_BUFFER_SIZE];
+static volatile uint32_t tx_head;
+static volatile uint32_t tx_tail;
+static volatile uint32_t tx_dropped;
+
+/*
+ * Queue bytes in the TX ring buffer
+ * - All-or-nothing, so that concurrent lines never interleave
+ * - BASEPRI masking serializes producers and keeps the TX ISR out while
+ *   the buffer is filled and TIE is set
+ * - 'count_drop' adds the bytes to tx_dropped if they do not fit
+ */
+static size_t lpuart_queue(const void *buf, size_t len, bool count_drop) {
+    const uint8_t *src = buf;
+    UBaseType_t mask = taskENTER_CRITICAL_FROM_ISR();
+    uint32_t head = tx_head;
+    size_t space = LPUART_TX_BUFFER_SIZE - (head - tx_tail);
+    size_t first;
+
+    if (len > space) {
+        if (count_drop) {
+            tx_dropped += len;
+        }
+        taskEXIT_CRITICAL_FROM_ISR(mask);
+        return 0;
+    }
+
+    /* Copy in at most two chunks (before and after the wrap point) */
+    first = LPUART_TX_BUFFER_SIZE - (head & LPUART_TX_MASK);
+    if (first > len) {
+        first = len;
+    }
+    memcpy(&tx_buffer[head & LPUART_TX_MASK], src, first);
+    memcpy(tx_buffer, src + first, len - first);
+
+    /* Publish the data before the new head index */
+    __asm volatile ("dmb" ::: "memory");
+    tx_head = head + len;
+
+    /* Let the TX interrupt drain the buffer */
+    LPUART_CTRL |= LPUART_CTRL_TIE;
+
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+    return len;
+}
+
+size_t lpuart_write(const void *buf, size_t len) {
+    return lpuart_queue(buf, len, true);
+}
+
+size_t lpuart_try_write(const void *buf, size_t len) {
+    return lpuart_queue(buf, len, false);
+}
+
+/*
+ * Non-blocking printf function for LPUART
+ * - Queues a null-terminated string in the TX ring buffer
+ * - Returns immediately; the TX interrupt sends the characters
+ */
+void my_printf(const char *str) {
+    lpuart_write(str, strlen(str));
+}
 
 /*
  * Simple blocking printf function for LPUART
  * - Sends a null-terminated string over the UART
  * - Waits until the transmit buffer is empty before sending each character
+ * - Only meant for contexts where the TX interrupt cannot run (e.g. faults)
  */
-void my_printf(const char *str) {
+void my_printf_polled(const char *str) {
     while (*str) {
         /* Wait until the Transmit Data Register Empty (TDRE) flag is set */
         while (!(LPUART_STAT & LPUART_STAT_TDRE)) {
@@ -17,13 +98,51 @@ void my_printf(const char *str) {
     }
 }
 
+size_t lpuart_tx_free(void) {
+    return LPUART_TX_BUFFER_SIZE - (tx_head - tx_tail);
+}
+
+uint32_t lpuart_tx_dropped(void) {
+    return tx_dropped;
+}
+
+/*
+ * LPUART0 interrupt handler
+ * - Feeds the DATA register while TDRE is set and bytes are pending
+ * - Disables the TX interrupt once the ring buffer is empty
+ */
+void LPUART0_Handler(void) {
+    uint32_t tail = tx_tail;
+    UBaseType_t mask;
+
+    while (tail != tx_head && (LPUART_STAT & LPUART_STAT_TDRE)) {
+        LPUART_DATA = tx_buffer[tail & LPUART_TX_MASK];
+        tail++;
+    }
+    tx_tail = tail;
+
+    /* Re-check under the mask: a producer may have queued data meanwhile */
+    mask = taskENTER_CRITICAL_FROM_ISR();
+    if (tx_tail == tx_head) {
+        LPUART_CTRL &= ~LPUART_CTRL_TIE;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
 /*
  * Initialize the LPUART peripheral
  * - Set a default baud rate
  * - Enable transmitter (TE) and receiver (RE)
+ * - Enable the LPUART0 line in the NVIC (TIE is set on demand by lpuart_write)
  */
 void lpuart_init(void){
+    tx_head = 0;
+    tx_tail = 0;
+    tx_dropped = 0;
+
     LPUART_BAUD = 0x1A0;                 /* Example baud rate configuration */
     LPUART_CTRL |= (LPUART_CTRL_TE | LPUART_CTRL_RE); /* Enable TX and RX */
-}
 
+    nvic_set_priority(LPUART0_IRQn, LPUART0_IRQ_PRIORITY);
+    nvic_enable_irq(LPUART0_IRQn);
+}
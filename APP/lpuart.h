@@ -2,6 +2,7 @@
 #define LPUART_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 /* 
  * Base address for LPUART0 peripheral 
@@ -9,6 +10,9 @@
  */
 #define LPUART0_BASE_ADDR   0x40328000
 
+/* NVIC interrupt line of LPUART0 */
+#define LPUART0_IRQn        141
+
 /* 
  * LPUART register definitions using memory-mapped I/O
  * Access is volatile to prevent compiler optimizations
@@ -21,15 +25,54 @@
 /* Bit masks for LPUART status/control registers */
 #define LPUART_STAT_TDRE    (1 << 23) /* Transmit Data Register Empty */
 #define LPUART_STAT_RDRF    (1 << 21) /* Receive Data Register Full */
+#define LPUART_CTRL_TIE     (1 << 23) /* Transmit Interrupt Enable */
+#define LPUART_CTRL_RIE     (1 << 21) /* Receiver Interrupt Enable */
 #define LPUART_CTRL_TE      (1 << 19) /* Transmitter Enable */
 #define LPUART_CTRL_RE      (1 << 18) /* Receiver Enable */
 
+/*
+ * Size of the TX ring buffer in bytes (must be a power of two)
+ * - Filled by tasks/ISRs, drained by the LPUART0 TX interrupt
+ */
+#ifndef LPUART_TX_BUFFER_SIZE
+#define LPUART_TX_BUFFER_SIZE 1024
+#endif
+
+/* NVIC priority of the LPUART0 interrupt (must not be above configMAX_SYSCALL_INTERRUPT_PRIORITY) */
+#define LPUART0_IRQ_PRIORITY 15
+
 /* Functions for basic LPUART operation */
 
-/* Blocking printf-style output using LPUART */
+/*
+ * Non-blocking printf-style output using LPUART
+ * - Queues the whole string in the TX ring buffer, or drops it if it does not fit
+ * - Safe to call from tasks and from ISRs up to configMAX_SYSCALL_INTERRUPT_PRIORITY
+ */
 void my_printf(const char *str);
 
-/* Initialize LPUART0: set baud rate and enable TX/RX */
+/* Blocking output that bypasses the ring buffer (fault handlers, interrupts disabled) */
+void my_printf_polled(const char *str);
+
+/*
+ * Queue 'len' bytes for transmission
+ * - Returns 'len' on success, 0 if the buffer had not enough room (data dropped)
+ * - Safe to call from tasks and from ISRs up to configMAX_SYSCALL_INTERRUPT_PRIORITY
+ */
+size_t lpuart_write(const void *buf, size_t len);
+
+/* Same as lpuart_write(), but the caller keeps the data on failure: not counted as dropped */
+size_t lpuart_try_write(const void *buf, size_t len);
+
+/* Free space in the TX ring buffer, in bytes */
+size_t lpuart_tx_free(void);
+
+/* Number of bytes dropped because the TX ring buffer was full */
+uint32_t lpuart_tx_dropped(void);
+
+/* LPUART0 interrupt handler: drains the TX ring buffer */
+void LPUART0_Handler(void);
+
+/* Initialize LPUART0: set baud rate, enable TX/RX and the TX interrupt line */
 void lpuart_init(void);
 
 #endif /* LPUART_H */
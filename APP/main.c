@@ -1,49 +1,34 @@
 #include "FreeRTOS.h"
 #include "task.h"
-#include "semphr.h"
 #include "lpuart.h"
 #include "flexcan.h"
-#include <stdio.h>
+#include "can_dispatch.h"
+#include "demo_dbc.h"
+#include "log.h"
 
 /* Task periodicity in milliseconds */
 #define UART_TASK_DELAY_MS 500
 #define CAN_TASK_DELAY_MS 1000
 
+/* Maximum number of frames drained per wake-up of the CAN1 task */
+#define CAN_RX_BATCH 8
+
 /* Global objects */
 CanBus can_bus;
 FlexCANState flexcan0;
 FlexCANState flexcan1;
-SemaphoreHandle_t print_mutex;
+CanDispatch can1_dispatch;
 
 /* 
- * Thread-safe printing via UART
- * - Ensures only one task prints at a time
+ * CAN handler for the CAN0_COUNTER message on FlexCAN1
+ * - Called by the CAN1 dispatch table
+ * - Decodes the signals in place (generated from dbc/demo.dbc) and logs them
  */
-void my_printf_safe(const char *str) {
-    if (xSemaphoreTake(print_mutex, portMAX_DELAY) == pdTRUE) {
-        my_printf(str);
-        xSemaphoreGive(print_mutex);
-    }
-}
-
-/* 
- * CAN receive callback for FlexCAN1
- * - Called whenever a frame is received
- * - Prints frame ID and data
- */
-void can_receive_callback(FlexCANState *s, CanFrame *frame) {
-    (void)*s;  /* Unused */
-    char buf[64];
-
-    sprintf(buf, "Received CAN1 frame: ID=%03lX Data=", frame->id);
-    my_printf_safe(buf);
+static void can_counter_handler(const CanFrame *frame, void *ctx) {
+    (void)ctx;  /* Unused */
 
-    for (int i = 0; i < frame->dlc; i++) {
-        sprintf(buf, "%02X ", frame->data[i]);
-        my_printf_safe(buf);
-    }
-
-    my_printf_safe("\r\n");
+    LOG("Received CAN1 frame: ID=%03lX even=%02X odd=%02X\r\n", frame->id,
+        can0_counter_count_even_get(frame->data), can0_counter_count_odd_get(frame->data));
 }
 
 /* UART Task: prints a message periodically */
@@ -62,18 +47,12 @@ void can0_task(void *pvParameters) {
 
     while (1) {
         CanFrame frame;
-        frame.id = 0x123;
-        frame.dlc = 2;
-        frame.data[0] = counter++;
-        frame.data[1] = counter++;
-
-        char buf[32];
-        my_printf("CAN0 sent frame: ");
-        for (int i = 0; i < frame.dlc; i++) {
-            sprintf(buf, "%02X ", frame.data[i]);
-            my_printf_safe(buf);
-        }
-        my_printf("\r\n");
+        frame.id = CAN0_COUNTER_ID;
+        frame.dlc = CAN0_COUNTER_DLC;
+        can0_counter_count_even_set(frame.data, counter++);
+        can0_counter_count_odd_set(frame.data, counter++);
+
+        LOG("CAN0 sent frame: %02X %02X\r\n", frame.data[0], frame.data[1]);
 
         /* Transmit frame on the logical CAN bus */
         can_bus_transmit(&can_bus, &flexcan0, &frame);
@@ -82,31 +61,34 @@ void can0_task(void *pvParameters) {
     }
 }
 
-/* CAN1 Task: receives frames from its RX buffer */
+/* CAN1 Task: sleeps until frames arrive, then drains its RX buffer */
 void can1_task(void *pvParameters) {
     (void)pvParameters;
     uint32_t received_count = 0;
+    CanFrame frames[CAN_RX_BATCH];
+
+    /* Get woken by FlexCAN1 on every received frame */
+    flexcan_set_rx_task(&flexcan1, xTaskGetCurrentTaskHandle());
 
     while (1) {
-        CanFrame frame;
+        size_t count = flexcan_wait_receive(&flexcan1, frames, CAN_RX_BATCH, portMAX_DELAY);
 
-        /* Check if a frame is available */
-        if (flexcan_receive(&flexcan1, &frame)) {
-            received_count++;
-            char buf[64];
-            sprintf(buf, "CAN1 Task: frame received count=%lu\r\n", received_count);
-            my_printf_safe(buf);
+        for (size_t i = 0; i < count; i++) {
+            can_dispatch_frame(&can1_dispatch, &frames[i]);
         }
 
-        vTaskDelay(pdMS_TO_TICKS(200));
+        if (count > 0) {
+            received_count += count;
+            LOG("CAN1 Task: frame received count=%lu unhandled=%lu\r\n",
+                received_count, can1_dispatch.unhandled);
+        }
     }
 }
 
 /* Main function */
 int main(void) {
-    /* Initialize UART and printing mutex */
+    /* Initialize UART (interrupt-driven TX ring buffer) */
     lpuart_init();
-    print_mutex = xSemaphoreCreateMutex();
 
     /* Initialize CAN nodes and bus */
     flexcan_init(&flexcan0);
@@ -119,13 +101,18 @@ int main(void) {
     can_bus_add_node(&can_bus, &flexcan0);
     can_bus_add_node(&can_bus, &flexcan1);
 
-    /* Set callback for CAN1 reception */
-    flexcan1.receive_callback = can_receive_callback;
+    /* Register the CAN1 message handlers */
+    can_dispatch_init(&can1_dispatch);
+    demo_dbc_register(&can1_dispatch, &(DemoDbcHandlers){
+        .can0_counter = can_counter_handler,
+    }, NULL);
+    can_dispatch_build(&can1_dispatch);
 
     /* Create FreeRTOS tasks */
     xTaskCreate(uart_task, "UART Task", 256, NULL, 1, NULL);
     xTaskCreate(can0_task, "CAN0 Task", 256, NULL, 1, NULL);
     xTaskCreate(can1_task, "CAN1 Task", 256, NULL, 2, NULL);
+    xTaskCreate(log_task, "Log Task", 256, NULL, tskIDLE_PRIORITY + 1, NULL);
 
     /* Start the FreeRTOS scheduler */
     vTaskStartScheduler();
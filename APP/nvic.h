@@ -0,0 +1,32 @@
+#ifndef NVIC_H
+#define NVIC_H
+
+#include <stdint.h>
+
+/* Number of priority bits implemented by the S32K3xx NVIC */
+#define NVIC_PRIO_BITS      4
+
+/*
+ * NVIC register definitions using memory-mapped I/O
+ * (System Control Space of the Cortex-M7 core)
+ */
+#define NVIC_ISER(n)        (*(volatile uint32_t *)(0xE000E100 + 4 * (n))) /* Interrupt Set-Enable */
+#define NVIC_ICER(n)        (*(volatile uint32_t *)(0xE000E180 + 4 * (n))) /* Interrupt Clear-Enable */
+#define NVIC_IPR(n)         (*(volatile uint8_t *)(0xE000E400 + (n)))      /* Interrupt Priority (byte access) */
+
+/* Enable an external interrupt line in the NVIC */
+static inline void nvic_enable_irq(uint32_t irq) {
+    NVIC_ISER(irq >> 5) = 1u << (irq & 31);
+}
+
+/* Disable an external interrupt line in the NVIC */
+static inline void nvic_disable_irq(uint32_t irq) {
+    NVIC_ICER(irq >> 5) = 1u << (irq & 31);
+}
+
+/* Set the priority of an external interrupt (0 = highest, 15 = lowest) */
+static inline void nvic_set_priority(uint32_t irq, uint8_t prio) {
+    NVIC_IPR(irq) = (uint8_t)(prio << (8 - NVIC_PRIO_BITS));
+}
+
+#endif /* NVIC_H */
@@ -12,6 +12,9 @@ extern void xPortSysTickHandler( void );
 /* (Opzionale) tuo handler CAN se in futuro userai IRQ */
 void FLEXCAN0_Handler(void) __attribute__((weak, alias("Default_Handler")));
 
+/* LPUART0 TX interrupt (ring buffer drain, see lpuart.c) */
+void LPUART0_Handler(void) __attribute__((weak, alias("Default_Handler")));
+
 /* Exception handlers. */
 static void HardFault_Handler( void ) __attribute__( ( naked ) );
 static void Default_Handler( void ) __attribute__( ( naked ) );
@@ -39,8 +42,10 @@ const uint32_t* isr_vector[] __attribute__((section(".isr_vector"), used)) =
     (uint32_t*)&xPortPendSVHandler,      // [14] PendSV
     (uint32_t*)&xPortSysTickHandler,     // [15] SysTick
 
-    /* IRQs: tutto Default_Handler per ora */
-    [16 ... 240] = (uint32_t*)&Default_Handler
+    /* IRQs: tutto Default_Handler tranne LPUART0 */
+    [16 ... 16 + LPUART0_IRQn - 1] = (uint32_t*)&Default_Handler,
+    [16 + LPUART0_IRQn] = (uint32_t*)&LPUART0_Handler,
+    [16 + LPUART0_IRQn + 1 ... 240] = (uint32_t*)&Default_Handler
     /* Quando userai l’IRQ CAN, sostituisci l’indice corretto con FLEXCAN0_Handler */
     /* Esempio (indice fittizio!):
        [IRQ_BASE_FOR_FLEXCAN0] = (uint32_t*)&FLEXCAN0_Handler,
@@ -66,7 +71,7 @@ void prvGetRegistersFromStack( uint32_t *pulFaultStackAddress )
     lr = pulFaultStackAddress[ 5 ];
     pc = pulFaultStackAddress[ 6 ];
     psr = pulFaultStackAddress[ 7 ];
-    my_printf("Calling prvGetRegistersFromStack() from fault handler");
+    my_printf_polled("Calling prvGetRegistersFromStack() from fault handler");
     for( ;; );
 }
 
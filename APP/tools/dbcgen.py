@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+"""
+DBC to C header generator for the APP CAN stack.
+
+For every message (BO_) and signal (SG_) of a DBC file, emits static inline
+get/set routines that work directly on CanFrame.data. The bit layout is
+resolved at generation time, so each accessor is a fixed sequence of
+shift/mask operations on constant byte offsets (no generic bit loop, no
+intermediate copy). Also emits a handler table registering one CanHandler
+per message in a CanDispatch (see can_dispatch.h).
+
+Usage: dbcgen.py input.dbc output.h
+"""
+
+import os
+import re
+import sys
+
+BO_RE = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)")
+SG_RE = re.compile(r"^\s*SG_\s+(\w+)\s*(M|m\d+)?\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+                   r"\(\s*([-+.\deE]+)\s*,\s*([-+.\deE]+)\s*\)\s*"
+                   r"\[\s*([-+.\deE]+)\s*\|\s*([-+.\deE]+)\s*\]\s*\"([^\"]*)\"")
+
+CAN_EFF_FLAG = 0x80000000  # DBC marks extended IDs with bit 31
+CAN_EFF_MASK = 0x1FFFFFFF
+
+
+class Signal:
+    def __init__(self, m):
+        self.name = m.group(1)
+        self.mux = m.group(2)
+        self.start = int(m.group(3))
+        self.length = int(m.group(4))
+        self.little_endian = m.group(5) == "1"
+        self.signed = m.group(6) == "-"
+        self.factor = float(m.group(7))
+        self.offset = float(m.group(8))
+        self.minimum = m.group(9)
+        self.maximum = m.group(10)
+        self.unit = m.group(11)
+
+    def bit_map(self):
+        """Return [(value bit, byte, bit in byte)] for every bit of the signal."""
+        bits = []
+        if self.little_endian:
+            for j in range(self.length):
+                pos = self.start + j
+                bits.append((j, pos // 8, pos % 8))
+        else:
+            # Motorola: start bit is the MSB, numbering runs MSB-first per byte
+            pos = self.start
+            for j in reversed(range(self.length)):
+                bits.append((j, pos // 8, pos % 8))
+                pos = pos + 15 if pos % 8 == 0 else pos - 1
+        return bits
+
+    def runs(self):
+        """Group the bit map into (byte, shift in byte, value shift, width) runs."""
+        by_byte = {}
+        for val, byte, bit in self.bit_map():
+            by_byte.setdefault(byte, []).append((bit, val))
+        result = []
+        for byte in sorted(by_byte):
+            pairs = sorted(by_byte[byte])
+            start = pairs[0]
+            width = 1
+            for prev, cur in zip(pairs, pairs[1:]):
+                if cur[0] == prev[0] + 1 and cur[1] == prev[1] + 1:
+                    width += 1
+                else:
+                    result.append((byte, start[0], start[1], width))
+                    start, width = cur, 1
+            result.append((byte, start[0], start[1], width))
+        return result
+
+    def raw_type(self, signed=False):
+        for size in (8, 16, 32, 64):
+            if self.length <= size:
+                return "%sint%d_t" % ("" if signed else "u", size)
+        raise ValueError("signal %s longer than 64 bits" % self.name)
+
+    def max_byte(self):
+        return max(byte for _, byte, _ in self.bit_map())
+
+
+class Message:
+    def __init__(self, m):
+        raw_id = int(m.group(1))
+        self.extended = bool(raw_id & CAN_EFF_FLAG)
+        self.can_id = raw_id & CAN_EFF_MASK if self.extended else raw_id
+        self.name = m.group(2)
+        self.dlc = int(m.group(3))
+        self.sender = m.group(4)
+        self.signals = []
+
+
+def parse_dbc(path):
+    messages = []
+    with open(path, encoding="latin-1") as f:
+        for line in f:
+            m = BO_RE.match(line)
+            if m:
+                messages.append(Message(m))
+                continue
+            m = SG_RE.match(line)
+            if m and messages:
+                messages[-1].signals.append(Signal(m))
+    return messages
+
+
+def c_float(value):
+    text = repr(float(value))
+    return text + "f" if "e" in text or "." in text else text + ".0f"
+
+
+def gen_get(msg, sig, prefix):
+    utype = sig.raw_type()
+    parts = []
+    for byte, shift, vshift, width in sig.runs():
+        expr = "d[%d]" % byte
+        if shift:
+            expr = "(%s >> %d)" % (expr, shift)
+        if shift + width < 8:
+            expr = "(%s & 0x%Xu)" % (expr, (1 << width) - 1)
+        expr = "(%s)%s" % (utype, expr)
+        if vshift:
+            expr = "(%s << %d)" % (expr, vshift)
+        parts.append(expr)
+
+    out = []
+    out.append("/* %s.%s: %d|%d@%d%s (%s,%s) [%s|%s] \"%s\" */" % (
+        msg.name, sig.name, sig.start, sig.length, 1 if sig.little_endian else 0,
+        "-" if sig.signed else "+", repr(sig.factor), repr(sig.offset),
+        sig.minimum, sig.maximum, sig.unit))
+    if sig.signed:
+        stype = sig.raw_type(signed=True)
+        bits = int(stype[3:-2])
+        out.append("static inline %s %s_get(const uint8_t *d) {" % (stype, prefix))
+        out.append("    %s raw = %s;" % (utype, " | ".join(parts)))
+        if sig.length < bits:
+            out.append("    return (%s)(%s)(raw << %d) >> %d;" % (
+                stype, utype, bits - sig.length, bits - sig.length))
+        else:
+            out.append("    return (%s)raw;" % stype)
+    else:
+        out.append("static inline %s %s_get(const uint8_t *d) {" % (utype, prefix))
+        out.append("    return %s;" % " | ".join(parts))
+    out.append("}")
+    return out
+
+
+def gen_set(sig, prefix):
+    utype = sig.raw_type()
+    vtype = sig.raw_type(signed=sig.signed)
+    out = ["static inline void %s_set(uint8_t *d, %s value) {" % (prefix, vtype)]
+    if sig.signed:
+        out.append("    %s v = (%s)value;" % (utype, utype))
+    else:
+        out.append("    %s v = value;" % utype)
+    for byte, shift, vshift, width in sig.runs():
+        mask = (1 << width) - 1
+        field = "v" if not vshift else "(v >> %d)" % vshift
+        if width < sig.length or sig.length < 8:
+            field = "(%s & 0x%Xu)" % (field, mask)
+        if shift:
+            field = "(%s << %d)" % (field, shift)
+        if width == 8:
+            out.append("    d[%d] = (uint8_t)%s;" % (byte, field))
+        else:
+            out.append("    d[%d] = (uint8_t)((d[%d] & 0x%02Xu) | %s);" % (
+                byte, byte, ~(mask << shift) & 0xFF, field))
+    out.append("}")
+    return out
+
+
+def gen_phys(sig, prefix):
+    if sig.factor == 1.0 and sig.offset == 0.0:
+        return []
+    vtype = sig.raw_type(signed=sig.signed)
+    return [
+        "static inline float %s_decode(const uint8_t *d) {" % prefix,
+        "    return (float)%s_get(d) * %s + %s;" % (prefix, c_float(sig.factor), c_float(sig.offset)),
+        "}",
+        "static inline void %s_encode(uint8_t *d, float value) {" % prefix,
+        "    float raw = (value - %s) / %s;" % (c_float(sig.offset), c_float(sig.factor)),
+        "    %s_set(d, (%s)(raw < 0.0f ? raw - 0.5f : raw + 0.5f));" % (prefix, vtype),
+        "}",
+    ]
+
+
+def generate(messages, db, dbc_name):
+    guard = "%s_DBC_H" % db.upper()
+    table = "%sDbcHandlers" % "".join(w.capitalize() for w in db.split("_"))
+    out = [
+        "/* Generated by tools/dbcgen.py from %s - do not edit */" % dbc_name,
+        "",
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#include <stdint.h>",
+        "#include <stdbool.h>",
+        "#include \"can_dispatch.h\"",
+        "",
+    ]
+
+    for msg in messages:
+        upper = msg.name.upper()
+        lower = msg.name.lower()
+        out.append("/* -------------------- %s (0x%X%s, sent by %s) -------------------- */" % (
+            msg.name, msg.can_id, ", extended" if msg.extended else "", msg.sender))
+        out.append("#define %s_ID 0x%Xu" % (upper, msg.can_id))
+        out.append("#define %s_DLC %du" % (upper, msg.dlc))
+        out.append("")
+        for sig in msg.signals:
+            if sig.max_byte() >= msg.dlc:
+                sys.exit("%s.%s: signal exceeds DLC %d" % (msg.name, sig.name, msg.dlc))
+            prefix = "%s_%s" % (lower, sig.name.lower())
+            if sig.mux:
+                out.append("/* Multiplexed signal (%s) */" % sig.mux)
+            out += gen_get(msg, sig, prefix)
+            out += gen_set(sig, prefix)
+            out += gen_phys(sig, prefix)
+            out.append("")
+
+    out.append("/* -------------------- Message table -------------------- */")
+    out.append("")
+    out.append("/* X(NAME, name, id, dlc) for every message of %s */" % dbc_name)
+    out.append("#define %s_DBC_MESSAGES(X) \\" % db.upper())
+    for msg in messages:
+        out.append("    X(%s, %s, 0x%Xu, %du) \\" % (msg.name.upper(), msg.name.lower(), msg.can_id, msg.dlc))
+    out.append("")
+    out.append("/* One optional handler per message */")
+    out.append("typedef struct %s {" % table)
+    for msg in messages:
+        out.append("    CanHandler %s;" % msg.name.lower())
+    out.append("} %s;" % table)
+    out.append("")
+    out.append("/* Register every non-NULL handler in a dispatch table (by message ID) */")
+    out.append("static inline bool %s_dbc_register(CanDispatch *d, const %s *h, void *ctx) {" % (db, table))
+    out.append("    bool ok = true;")
+    out.append("")
+    for msg in messages:
+        out.append("    if (h->%s)" % msg.name.lower())
+        out.append("        ok &= can_dispatch_register(d, %s_ID, h->%s, ctx);" % (msg.name.upper(), msg.name.lower()))
+    out.append("    return ok;")
+    out.append("}")
+    out.append("")
+    out.append("#endif /* %s */" % guard)
+    return "\n".join(out) + "\n"
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.exit(__doc__.strip())
+    dbc_path, out_path = argv[1], argv[2]
+    db = re.sub(r"\W", "_", os.path.splitext(os.path.basename(dbc_path))[0]).lower()
+    text = generate(parse_dbc(dbc_path), db, os.path.basename(dbc_path))
+    with open(out_path, "w") as f:
+        f.write(text)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
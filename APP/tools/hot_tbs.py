@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+"""
+Hot translation block report: annotates the output of QEMU's hotblocks
+plugin (contrib/plugins/hotblocks.c) with the firmware function each block
+starts in, and shows each block's share of the instructions executed by
+the blocks listed.
+
+The plugin counts every execution of every TB and prints the hottest ones
+when QEMU exits; see the qemu_hotblocks target in the Makefile.
+
+Usage: hot_tbs.py demo.elf hotblocks.log
+"""
+
+import bisect
+import re
+import struct
+import sys
+
+SHT_SYMTAB = 2
+STT_FUNC = 2
+
+# "pc, tcount, icount, ecount" lines printed by the plugin
+LINE_RE = re.compile(r"^0x([0-9a-f]+), (\d+), (\d+), (\d+)$")
+
+
+def load_functions(elf_path):
+    """Return a sorted list of (address, size, name) for the ELF's functions."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        sys.exit("%s: not a 32-bit little-endian ELF" % elf_path)
+
+    e_shoff, = struct.unpack_from("<I", elf, 0x20)
+    e_shentsize, e_shnum = struct.unpack_from("<HH", elf, 0x2E)
+
+    def section(i):
+        # sh_name, sh_type, sh_flags, sh_addr, sh_offset, sh_size, sh_link
+        return struct.unpack_from("<IIIIIII", elf, e_shoff + i * e_shentsize)
+
+    funcs = []
+    for i in range(e_shnum):
+        _, sh_type, _, _, offset, size, link = section(i)
+        if sh_type != SHT_SYMTAB:
+            continue
+        strtab = section(link)[4]
+        for sym in range(offset, offset + size, 16):
+            name, value, sym_size, info = struct.unpack_from("<IIIB", elf, sym)
+            if info & 0xF != STT_FUNC:
+                continue
+            end = elf.index(b"\0", strtab + name)
+            # Clear the Thumb bit
+            funcs.append((value & ~1, sym_size,
+                          elf[strtab + name:end].decode("ascii", "replace")))
+
+    if not funcs:
+        sys.exit("%s: no function symbols (stripped?)" % elf_path)
+    funcs.sort()
+    return funcs
+
+
+def symbolize(funcs, starts, pc):
+    i = bisect.bisect_right(starts, pc) - 1
+    if i >= 0:
+        addr, size, name = funcs[i]
+        if pc < addr + max(size, 1):
+            return "%s+0x%x" % (name, pc - addr)
+    return "?"
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.exit(__doc__.strip())
+
+    funcs = load_functions(argv[1])
+    starts = [f[0] for f in funcs]
+
+    blocks = []
+    with open(argv[2]) as f:
+        for line in f:
+            m = LINE_RE.match(line.strip())
+            if m:
+                blocks.append(tuple(int(g, 16 if i == 0 else 10)
+                                    for i, g in enumerate(m.groups())))
+    if not blocks:
+        sys.exit("%s: no hotblocks plugin output" % argv[2])
+
+    total = sum(insns * execs for _, _, insns, execs in blocks)
+    print("%-10s %-32s %6s %6s %12s %6s"
+          % ("pc", "function", "trans", "insns", "execs", "insn%"))
+    for pc, trans, insns, execs in blocks:
+        print("0x%08x %-32s %6d %6d %12d %5.1f%%"
+              % (pc, symbolize(funcs, starts, pc), trans, insns, execs,
+                 100.0 * insns * execs / total if total else 0))
+
+
+if __name__ == "__main__":
+    main(sys.argv)
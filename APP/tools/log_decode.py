@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""
+Host-side decoder for the APP deferred binary log (see log.h).
+
+Reads the UART byte stream (stdin or a file), passes plain text through and
+rebuilds LOG() records using the format strings stored in the .log_fmt
+section of the firmware ELF.
+
+Usage: log_decode.py demo.elf [capture.bin] [--timestamps]
+"""
+
+import re
+import struct
+import sys
+
+LOG_RECORD_MARKER = 0xFF
+LOG_MAX_ARGS = 4
+
+# printf conversion: flags, width, precision, length modifier, conversion
+FMT_RE = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diouxXcp%])")
+
+
+def load_log_fmt(elf_path):
+    """Return the raw contents of the .log_fmt section of a 32-bit LE ELF."""
+    with open(elf_path, "rb") as f:
+        elf = f.read()
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        sys.exit("%s: not a 32-bit little-endian ELF" % elf_path)
+
+    e_shoff, = struct.unpack_from("<I", elf, 0x20)
+    e_shentsize, e_shnum, e_shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def section(i):
+        # sh_name, sh_type, sh_flags, sh_addr, sh_offset, sh_size
+        return struct.unpack_from("<IIIIII", elf, e_shoff + i * e_shentsize)
+
+    shstr = section(e_shstrndx)
+    for i in range(e_shnum):
+        name, _, _, _, offset, size = section(i)
+        start = shstr[4] + name
+        if elf[start:elf.index(b"\0", start)] == b".log_fmt":
+            return elf[offset:offset + size]
+
+    sys.exit("%s: no .log_fmt section" % elf_path)
+
+
+def format_record(strings, fmt_id, args):
+    """Rebuild the text of a record from its format-string ID and arguments."""
+    end = strings.find(b"\0", fmt_id)
+    if fmt_id >= len(strings) or end < 0:
+        return "<unknown LOG id %d>\n" % fmt_id
+    fmt = strings[fmt_id:end].decode("ascii", "replace")
+    values = iter(args)
+
+    def convert(m):
+        flags, conv = m.group(1), m.group(2)
+        if conv == "%":
+            return "%"
+        value = next(values, 0)
+        if conv in "di":
+            value = value - (1 << 32) if value & 0x80000000 else value
+        elif conv == "p":
+            return "0x%08x" % value
+        elif conv == "u":
+            conv = "d"
+        return ("%" + flags + conv) % value
+
+    return FMT_RE.sub(convert, fmt)
+
+
+def decode(stream, strings, timestamps):
+    out = sys.stdout
+    while True:
+        byte = stream.read(1)
+        if not byte:
+            break
+        if byte[0] != LOG_RECORD_MARKER:
+            out.write(byte.decode("latin-1"))
+            out.flush()
+            continue
+
+        header = stream.read(7)
+        if len(header) < 7:
+            break
+        nargs, fmt_id, tick = struct.unpack("<BHI", header)
+        if nargs > LOG_MAX_ARGS:
+            out.write("<corrupt LOG record>\n")
+            continue
+        payload = stream.read(4 * nargs)
+        if len(payload) < 4 * nargs:
+            break
+
+        if timestamps:
+            out.write("[%10u] " % tick)
+        out.write(format_record(strings, fmt_id, struct.unpack("<%dI" % nargs, payload)))
+        out.flush()
+
+
+def main(argv):
+    timestamps = "--timestamps" in argv
+    argv = [a for a in argv if a != "--timestamps"]
+    if len(argv) < 2:
+        sys.exit(__doc__.strip())
+
+    strings = load_log_fmt(argv[1])
+    if len(argv) > 2:
+        with open(argv[2], "rb") as stream:
+            decode(stream, strings, timestamps)
+    else:
+        decode(sys.stdin.buffer, strings, timestamps)
+
+
+if __name__ == "__main__":
+    main(sys.argv)
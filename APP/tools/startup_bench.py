@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""
+Startup benchmark: time from launching QEMU to the first byte the firmware
+writes on the serial console, which covers machine creation, ELF loading
+and the translation of everything the firmware runs before its first
+UART write.
+
+Each run starts the given command with the serial port on stdout, waits
+for the first byte, then kills QEMU. Prints min/median/mean over the runs.
+Use it to compare QEMU builds or options, e.g. by running it once per
+configuration.
+
+Usage: startup_bench.py [--runs N] [--timeout S] -- qemu-system-arm args...
+"""
+
+import os
+import select
+import signal
+import statistics
+import subprocess
+import sys
+import time
+
+DEFAULT_RUNS = 20
+DEFAULT_TIMEOUT = 30.0
+
+
+def time_to_first_byte(cmd, timeout):
+    """Return the seconds from launching cmd to its first stdout byte."""
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, stdin=subprocess.DEVNULL,
+                            stdout=subprocess.PIPE,
+                            stderr=subprocess.DEVNULL)
+    try:
+        ready, _, _ = select.select([proc.stdout], [], [], timeout)
+        elapsed = time.perf_counter() - start
+        if not ready or not os.read(proc.stdout.fileno(), 1):
+            sys.exit("no serial output within %.0f s (or QEMU exited)"
+                     % timeout)
+        return elapsed
+    finally:
+        proc.send_signal(signal.SIGKILL)
+        proc.wait()
+
+
+def main(argv):
+    runs = DEFAULT_RUNS
+    timeout = DEFAULT_TIMEOUT
+
+    if "--" not in argv:
+        sys.exit(__doc__.strip())
+    sep = argv.index("--")
+    opts, cmd = argv[1:sep], argv[sep + 1:]
+    while opts:
+        opt = opts.pop(0)
+        if opt == "--runs" and opts:
+            runs = int(opts.pop(0))
+        elif opt == "--timeout" and opts:
+            timeout = float(opts.pop(0))
+        else:
+            sys.exit(__doc__.strip())
+    if not cmd or runs < 1:
+        sys.exit(__doc__.strip())
+
+    times = [time_to_first_byte(cmd, timeout) for _ in range(runs)]
+    print("time to first UART byte over %d runs: "
+          "min %.1f ms, median %.1f ms, mean %.1f ms"
+          % (runs, min(times) * 1e3, statistics.median(times) * 1e3,
+             statistics.mean(times) * 1e3))
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -936,12 +936,22 @@ static inline void cpu_loop_exec_tb(CPUState *cpu, TranslationBlock *tb,
     /*
      * If the next tb has more instructions than we have left to
      * execute we need to ensure we find/generate a TB with exactly
-     * insns_left instructions in it.
+     * insns_left instructions in it.  If its insns are weighted by
+     * cost, bound the cost instead: the last insn of a weighted TB can
+     * take its cost past CF_COUNT_MASK, so the bound may be lower than
+     * the budget left.
      */
-    if (insns_left > 0 && insns_left < tb->icount)  {
-        assert(insns_left <= CF_COUNT_MASK);
+    if (insns_left > 0 && insns_left < tb->icount_cost)  {
+        uint32_t cflags = tb->cflags & ~(CF_COUNT_MASK | CF_ICOUNT_CAP);
+
         assert(cpu->icount_extra == 0);
-        cpu->cflags_next_tb = (tb->cflags & ~CF_COUNT_MASK) | insns_left;
+        if (tb->icount_cost != tb->icount) {
+            cflags |= CF_ICOUNT_CAP | MIN(insns_left, CF_COUNT_MASK);
+        } else {
+            assert(insns_left <= CF_COUNT_MASK);
+            cflags |= insns_left;
+        }
+        cpu->cflags_next_tb = cflags;
     }
 #endif
 }
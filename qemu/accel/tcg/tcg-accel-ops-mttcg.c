@@ -115,6 +115,10 @@ static void *mttcg_cpu_thread_fn(void *arg)
         }
 
         qatomic_set_mb(&cpu->exit_request, 0);
+        if (idle_warp_enabled && all_cpu_threads_idle()) {
+            /* Let the main loop warp to the next timer deadline */
+            qemu_notify_event();
+        }
         qemu_wait_io_event(cpu);
     } while (!cpu->unplug || cpu_can_run(cpu));
 
@@ -37,6 +37,7 @@
 #include "qemu/units.h"
 #if !defined(CONFIG_USER_ONLY)
 #include "hw/boards.h"
+#include "hw/core/poll-wait.h"
 #endif
 #include "internal-common.h"
 
@@ -45,6 +46,8 @@ struct TCGState {
 
     bool mttcg_enabled;
     bool one_insn_per_tb;
+    bool idle_warp;
+    bool poll_wait;
     int splitwx_enabled;
     unsigned long tb_size;
 };
@@ -111,6 +114,10 @@ static int tcg_init_machine(MachineState *ms)
 
     tcg_allowed = true;
     mttcg_enabled = s->mttcg_enabled;
+#ifndef CONFIG_USER_ONLY
+    idle_warp_enabled = s->idle_warp;
+    poll_wait_enabled = s->poll_wait;
+#endif
 
     page_init();
     tb_htable_init();
@@ -207,6 +214,30 @@ static void tcg_set_one_insn_per_tb(Object *obj, bool value, Error **errp)
     qatomic_set(&one_insn_per_tb, value);
 }
 
+static bool tcg_get_idle_warp(Object *obj, Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    return s->idle_warp;
+}
+
+static void tcg_set_idle_warp(Object *obj, bool value, Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    s->idle_warp = value;
+}
+
+static bool tcg_get_poll_wait(Object *obj, Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    return s->poll_wait;
+}
+
+static void tcg_set_poll_wait(Object *obj, bool value, Error **errp)
+{
+    TCGState *s = TCG_STATE(obj);
+    s->poll_wait = value;
+}
+
 static int tcg_gdbstub_supported_sstep_flags(void)
 {
     /*
@@ -252,6 +283,20 @@ static void tcg_accel_class_init(ObjectClass *oc, void *data)
                                    tcg_set_one_insn_per_tb);
     object_class_property_set_description(oc, "one-insn-per-tb",
         "Only put one guest insn in each translation block");
+
+    object_class_property_add_bool(oc, "idle-warp",
+                                   tcg_get_idle_warp,
+                                   tcg_set_idle_warp);
+    object_class_property_set_description(oc, "idle-warp",
+        "Jump the virtual clock to the next timer deadline "
+        "when all vCPUs are idle");
+
+    object_class_property_add_bool(oc, "poll-wait",
+                                   tcg_get_poll_wait,
+                                   tcg_set_poll_wait);
+    object_class_property_set_description(oc, "poll-wait",
+        "Halt vCPUs that busy-poll a device register until "
+        "the device changes");
 }
 
 static const TypeInfo tcg_accel_type = {
@@ -119,17 +119,20 @@ static int64_t decode_sleb128(const uint8_t **pp)
    The logical table consists of TARGET_INSN_START_WORDS target_ulong's,
    which come from the target's insn_start data, followed by a uintptr_t
    which comes from the host pc of the end of the code implementing the insn.
+   With CF_USE_ICOUNT, a final column holds the icount cost of the TB
+   before the insn.
 
    Each line of the table is encoded as sleb128 deltas from the previous
-   line.  The seed for the first line is { tb->pc, 0..., tb->tc.ptr }.
-   That is, the first column is seeded with the guest pc, the last column
-   with the host pc, and the middle columns with zeros.  */
+   line.  The seed for the first line is { tb->pc, 0..., tb->tc.ptr, 0 }.
+   That is, the first column is seeded with the guest pc, the host pc
+   column with the host pc, and the other columns with zeros.  */
 
 static int encode_search(TranslationBlock *tb, uint8_t *block)
 {
     uint8_t *highwater = tcg_ctx->code_gen_highwater;
     uint64_t *insn_data = tcg_ctx->gen_insn_data;
     uint16_t *insn_end_off = tcg_ctx->gen_insn_end_off;
+    uint16_t *insn_cost = tcg_ctx->gen_insn_cost;
     uint8_t *p = block;
     int i, j, n;
 
@@ -148,6 +151,11 @@ static int encode_search(TranslationBlock *tb, uint8_t *block)
         prev = (i == 0 ? 0 : insn_end_off[i - 1]);
         curr = insn_end_off[i];
         p = encode_sleb128(p, curr - prev);
+        if (tb_cflags(tb) & CF_USE_ICOUNT) {
+            prev = (i == 0 ? 0 : insn_cost[i - 1]);
+            curr = insn_cost[i];
+            p = encode_sleb128(p, curr - prev);
+        }
 
         /* Test for (pending) buffer overflow.  The assumption is that any
            one row beginning below the high water mark cannot overrun
@@ -161,12 +169,19 @@ static int encode_search(TranslationBlock *tb, uint8_t *block)
     return p - block;
 }
 
+/*
+ * Find the insn containing HOST_PC, and return its insn_start data in
+ * DATA and the number of insns from it to the end of the TB.  With
+ * CF_USE_ICOUNT, also return in *COST the icount cost of the insns
+ * before it.
+ */
 static int cpu_unwind_data_from_tb(TranslationBlock *tb, uintptr_t host_pc,
-                                   uint64_t *data)
+                                   uint64_t *data, int *cost)
 {
     uintptr_t iter_pc = (uintptr_t)tb->tc.ptr;
     const uint8_t *p = tb->tc.ptr + tb->tc.size;
     int i, j, num_insns = tb->icount;
+    int iter_cost = 0;
 
     host_pc -= GETPC_ADJ;
 
@@ -188,7 +203,11 @@ static int cpu_unwind_data_from_tb(TranslationBlock *tb, uintptr_t host_pc,
             data[j] += decode_sleb128(&p);
         }
         iter_pc += decode_sleb128(&p);
+        if (tb_cflags(tb) & CF_USE_ICOUNT) {
+            iter_cost += decode_sleb128(&p);
+        }
         if (iter_pc > host_pc) {
+            *cost = iter_cost;
             return num_insns - i;
         }
     }
@@ -203,7 +222,8 @@ void cpu_restore_state_from_tb(CPUState *cpu, TranslationBlock *tb,
                                uintptr_t host_pc)
 {
     uint64_t data[TARGET_INSN_START_WORDS];
-    int insns_left = cpu_unwind_data_from_tb(tb, host_pc, data);
+    int cost;
+    int insns_left = cpu_unwind_data_from_tb(tb, host_pc, data, &cost);
 
     if (insns_left < 0) {
         return;
@@ -213,9 +233,11 @@ void cpu_restore_state_from_tb(CPUState *cpu, TranslationBlock *tb,
         assert(icount_enabled());
         /*
          * Reset the cycle counter to the start of the block and
-         * shift if to the number of actually executed instructions.
+         * shift if to the number of actually executed instructions
+         * (or their cost, which CF_ICOUNT_CAP may have clamped).
          */
-        cpu->neg.icount_decr.u16.low += insns_left;
+        cpu->neg.icount_decr.u16.low += tb->icount_cost -
+                                        MIN(cost, tb->icount_cost);
     }
 
     cpu->cc->tcg_ops->restore_state_to_opc(cpu, tb, data);
@@ -248,7 +270,8 @@ bool cpu_unwind_state_data(CPUState *cpu, uintptr_t host_pc, uint64_t *data)
     if (in_code_gen_buffer((const void *)(host_pc - tcg_splitwx_diff))) {
         TranslationBlock *tb = tcg_tb_lookup(host_pc);
         if (tb) {
-            return cpu_unwind_data_from_tb(tb, host_pc, data) >= 0;
+            int cost;
+            return cpu_unwind_data_from_tb(tb, host_pc, data, &cost) >= 0;
         }
     }
     return false;
@@ -85,15 +85,16 @@ static TCGOp *gen_tb_start(DisasContextBase *db, uint32_t cflags)
 }
 
 static void gen_tb_end(const TranslationBlock *tb, uint32_t cflags,
-                       TCGOp *icount_start_insn, int num_insns)
+                       TCGOp *icount_start_insn, int icount_cost)
 {
     if (cflags & CF_USE_ICOUNT) {
         /*
          * Update the num_insn immediate parameter now that we know
-         * the actual insn count.
+         * the actual insn count (or, for targets that weight insns,
+         * their total cost).
          */
         tcg_set_insn_param(icount_start_insn, 2,
-                           tcgv_i32_arg(tcg_constant_i32(num_insns)));
+                           tcgv_i32_arg(tcg_constant_i32(icount_cost)));
     }
 
     if (tcg_ctx->exitreq_label) {
@@ -121,6 +122,15 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
     TCGOp *icount_start_insn;
     TCGOp *first_insn_start = NULL;
     bool plugin_enabled;
+    /*
+     * When the icount budget left is smaller than a TB's cost, the TB is
+     * retranslated with CF_ICOUNT_CAP and the budget in CF_COUNT_MASK;
+     * never charge more than that, or the TB could not start.  Otherwise
+     * keep the cost of weighted TBs within what CF_COUNT_MASK can hold,
+     * like their insn count.  Neither applies without icount, or while
+     * every insn costs 1, so other TBs keep their usual length.
+     */
+    int cost_cap = cflags & CF_ICOUNT_CAP ? cflags & CF_COUNT_MASK : INT_MAX;
 
     /* Initialize DisasContext */
     db->tb = tb;
@@ -129,6 +139,7 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
     db->is_jmp = DISAS_NEXT;
     db->num_insns = 0;
     db->max_insns = *max_insns;
+    db->icount_cost = 0;
     db->insn_start = NULL;
     db->fake_insn = false;
     db->host_addr[0] = host_pc;
@@ -149,6 +160,8 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
 
     while (true) {
         *max_insns = ++db->num_insns;
+        tcg_ctx->gen_insn_cost[db->num_insns - 1] = db->icount_cost;
+        db->insn_cost = 1;
         ops->insn_start(db, cpu);
         db->insn_start = tcg_last_op();
         if (first_insn_start == NULL) {
@@ -167,6 +180,7 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
          * the next instruction.
          */
         ops->translate_insn(db, cpu);
+        db->icount_cost += db->insn_cost;
 
         /*
          * We can't instrument after instructions that change control
@@ -188,7 +202,9 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
 
         /* Stop translation if the output buffer is full,
            or we have executed all of the allowed instructions.  */
-        if (tcg_op_buf_full() || db->num_insns >= db->max_insns) {
+        if (tcg_op_buf_full() || db->num_insns >= db->max_insns ||
+            ((cflags & CF_USE_ICOUNT) && db->icount_cost != db->num_insns &&
+             db->icount_cost >= MIN(cost_cap, CF_COUNT_MASK))) {
             db->is_jmp = DISAS_TOO_MANY;
             break;
         }
@@ -196,7 +212,8 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
 
     /* Emit code to exit the TB, as indicated by db->is_jmp.  */
     ops->tb_stop(db, cpu);
-    gen_tb_end(tb, cflags, icount_start_insn, db->num_insns);
+    gen_tb_end(tb, cflags, icount_start_insn,
+               MIN(db->icount_cost, cost_cap));
 
     /*
      * Manage can_do_io for the translation block: set to false before
@@ -216,6 +233,7 @@ void translator_loop(CPUState *cpu, TranslationBlock *tb, int *max_insns,
     /* May be used by disas_log or plugin callbacks. */
     tb->size = db->pc_next - db->pc_first;
     tb->icount = db->num_insns;
+    tb->icount_cost = MIN(db->icount_cost, cost_cap);
 
     if (plugin_enabled) {
         plugin_gen_tb_end(cpu, db->num_insns);
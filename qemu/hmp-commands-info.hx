@@ -169,6 +169,19 @@ SRST
     Show the interrupts statistics (if available).
 ERST
 
+    {
+        .name       = "irq-latency",
+        .args_type  = "",
+        .params     = "",
+        .help       = "show the interrupt latency histograms (if available)",
+        .cmd_info_hrt = qmp_x_query_irq_latency,
+    },
+
+SRST
+  ``info irq-latency``
+    Show the interrupt latency histograms (if available).
+ERST
+
     {
         .name       = "pic",
         .args_type  = "",
@@ -25,6 +25,7 @@
 #include "target/arm/cpu-features.h"
 #include "target/arm/cpu-qom.h"
 #include "migration/vmstate.h"
+#include "exec/ram_addr.h"
 
 /* Bitbanded IO.  Each word corresponds to a single bit.  */
 
@@ -34,11 +35,85 @@ static inline hwaddr bitband_addr(BitBandState *s, hwaddr offset)
     return s->base | (offset & 0x1ffffff) >> 5;
 }
 
+/* Size of the source window covered by one 32MB bit-band alias region */
+#define BITBAND_SOURCE_SIZE 0x100000
+
+/*
+ * Return a host pointer to the @size bytes at @addr in the source memory
+ * if they are plain writable RAM, or NULL if the access must go through
+ * the memory API. The section last looked up is cached until the next
+ * memory topology change, so in the common case of an alias into SRAM
+ * this is just a range check. MMIO sections are cached too, with a NULL
+ * cache_host, so that repeated alias accesses to a peripheral do not
+ * look the section up each time either.
+ */
+static uint8_t *bitband_host_ptr(BitBandState *s, hwaddr addr, unsigned size)
+{
+    MemoryRegionSection section;
+
+    if (addr < s->cache_start ||
+        addr + size > s->cache_start + s->cache_size) {
+        s->cache_size = 0;
+
+        section = memory_region_find(s->source_memory, addr,
+                                     s->base + BITBAND_SOURCE_SIZE - addr);
+        if (!section.mr) {
+            return NULL;
+        }
+        s->cache_mr = section.mr;
+        s->cache_start = section.offset_within_address_space;
+        s->cache_size = int128_get64(section.size);
+        s->cache_offset = section.offset_within_region;
+        if (memory_access_is_direct(section.mr, true)) {
+            s->cache_host = memory_region_get_ram_ptr(section.mr) +
+                            section.offset_within_region;
+        } else {
+            s->cache_host = NULL;
+        }
+        memory_region_unref(section.mr);
+
+        if (addr < s->cache_start ||
+            addr + size > s->cache_start + s->cache_size) {
+            return NULL;
+        }
+    }
+
+    return s->cache_host ? s->cache_host + (addr - s->cache_start) : NULL;
+}
+
+/*
+ * Return true if a direct write of @size bytes at @addr in the cached
+ * RAM section needs no dirty memory bookkeeping: either nobody is
+ * tracking it, or those bytes are already dirty for every client that
+ * is (so in particular there are no translated code blocks to
+ * invalidate). Otherwise the write must go through the memory API,
+ * which takes care of that.
+ */
+static bool bitband_cache_write_is_clean(BitBandState *s, hwaddr addr,
+                                         unsigned size)
+{
+    uint8_t mask = memory_region_get_dirty_log_mask(s->cache_mr);
+    ram_addr_t ram_addr = memory_region_get_ram_addr(s->cache_mr) +
+        s->cache_offset + (addr - s->cache_start);
+
+    return !mask ||
+        !cpu_physical_memory_range_includes_clean(ram_addr, size, mask);
+}
+
+/* Invalidate the cached section when the memory map changes */
+static void bitband_source_commit(MemoryListener *listener)
+{
+    BitBandState *s = container_of(listener, BitBandState, source_listener);
+
+    s->cache_size = 0;
+}
+
 static MemTxResult bitband_read(void *opaque, hwaddr offset,
                                 uint64_t *data, unsigned size, MemTxAttrs attrs)
 {
     BitBandState *s = opaque;
     uint8_t buf[4];
+    uint8_t *host;
     MemTxResult res;
     int bitpos, bit;
     hwaddr addr;
@@ -47,12 +122,19 @@ static MemTxResult bitband_read(void *opaque, hwaddr offset,
 
     /* Find address in underlying memory and round down to multiple of size */
     addr = bitband_addr(s, offset) & (-size);
+    /* Bit position in the N bytes read... */
+    bitpos = (offset >> 2) & ((size * 8) - 1);
+
+    host = bitband_host_ptr(s, addr, size);
+    if (host) {
+        *data = (qatomic_read(&host[bitpos >> 3]) >> (bitpos & 7)) & 1;
+        return MEMTX_OK;
+    }
+
     res = address_space_read(&s->source_as, addr, attrs, buf, size);
     if (res) {
         return res;
     }
-    /* Bit position in the N bytes read... */
-    bitpos = (offset >> 2) & ((size * 8) - 1);
     /* ...converted to byte in buffer and bit in byte */
     bit = (buf[bitpos >> 3] >> (bitpos & 7)) & 1;
     *data = bit;
@@ -64,6 +146,7 @@ static MemTxResult bitband_write(void *opaque, hwaddr offset, uint64_t value,
 {
     BitBandState *s = opaque;
     uint8_t buf[4];
+    uint8_t *host;
     MemTxResult res;
     int bitpos, bit;
     hwaddr addr;
@@ -72,14 +155,29 @@ static MemTxResult bitband_write(void *opaque, hwaddr offset, uint64_t value,
 
     /* Find address in underlying memory and round down to multiple of size */
     addr = bitband_addr(s, offset) & (-size);
-    res = address_space_read(&s->source_as, addr, attrs, buf, size);
-    if (res) {
-        return res;
-    }
     /* Bit position in the N bytes read... */
     bitpos = (offset >> 2) & ((size * 8) - 1);
     /* ...converted to byte in buffer and bit in byte */
     bit = 1 << (bitpos & 7);
+
+    /*
+     * For RAM, only the byte holding the bit can change, so update it
+     * with a single atomic operation instead of a read and a write.
+     */
+    host = bitband_host_ptr(s, addr, size);
+    if (host && bitband_cache_write_is_clean(s, addr, size)) {
+        if (value & 1) {
+            qatomic_or(&host[bitpos >> 3], bit);
+        } else {
+            qatomic_and(&host[bitpos >> 3], ~bit);
+        }
+        return MEMTX_OK;
+    }
+
+    res = address_space_read(&s->source_as, addr, attrs, buf, size);
+    if (res) {
+        return res;
+    }
     if (value & 1) {
         buf[bitpos >> 3] |= bit;
     } else {
@@ -118,6 +216,12 @@ static void bitband_realize(DeviceState *dev, Error **errp)
     }
 
     address_space_init(&s->source_as, s->source_memory, "bitband-source");
+
+    s->source_listener = (MemoryListener) {
+        .name = "bitband-source",
+        .commit = bitband_source_commit,
+    };
+    memory_listener_register(&s->source_listener, &s->source_as);
 }
 
 /* Board init.  */
@@ -387,7 +491,7 @@ static void armv7m_realize(DeviceState *dev, Error **errp)
      * banked version of all of these.
      *
      * The default behaviour for unimplemented registers/ranges
-     * (for instance the Data Watchpoint and Trace unit at 0xe0001000)
+     * (for instance the Flash Patch and Breakpoint unit at 0xe0002000)
      * is to RAZ/WI for privileged access and BusFault for non-privileged
      * access.
      *
@@ -503,6 +607,34 @@ static void armv7m_realize(DeviceState *dev, Error **errp)
                                             &s->systick_ns_mem, 1);
     }
 
+    /* The ITM, which every Main Extension CPU has */
+    if (arm_feature(&s->cpu->env, ARM_FEATURE_M_MAIN)) {
+        object_initialize_child(OBJECT(dev), "itm", &s->itm, TYPE_ARMV7M_ITM);
+        sbd = SYS_BUS_DEVICE(&s->itm);
+        if (!sysbus_realize(sbd, errp)) {
+            return;
+        }
+        memory_region_add_subregion_overlap(&s->container, 0xe0000000,
+                                            sysbus_mmio_get_region(sbd, 0), 1);
+    }
+
+    /*
+     * The DWT. We model the v7M register layout only; v8M comparators
+     * work differently, and the baseline (v6M/v8M) DWT has no CYCCNT.
+     */
+    if (arm_feature(&s->cpu->env, ARM_FEATURE_M_MAIN) &&
+        !arm_feature(&s->cpu->env, ARM_FEATURE_V8)) {
+        object_initialize_child(OBJECT(dev), "dwt", &s->dwt, TYPE_ARMV7M_DWT);
+        s->dwt.cpu = s->cpu;
+        qdev_connect_clock_in(DEVICE(&s->dwt), "cpuclk", s->cpuclk);
+        sbd = SYS_BUS_DEVICE(&s->dwt);
+        if (!sysbus_realize(sbd, errp)) {
+            return;
+        }
+        memory_region_add_subregion_overlap(&s->container, 0xe0001000,
+                                            sysbus_mmio_get_region(sbd, 0), 1);
+    }
+
     /* If the CPU has RAS support, create the RAS register block */
     if (cpu_isar_feature(aa32_ras, s->cpu)) {
         object_initialize_child(OBJECT(dev), "armv7m-ras",
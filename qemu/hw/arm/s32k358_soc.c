@@ -11,6 +11,7 @@
 #include "qemu/log.h"                 // Logging
 #include "hw/can/can_bus.h"           // CAN bus infrastructure
 #include "hw/can/s32_flexcan.h"       // FlexCAN devices
+#include "hw/qdev-properties.h"       // Device properties
 
 // Initialize the S32K358 SoC instance
 static void s32k358_soc_initfn(Object *obj) {
@@ -56,6 +57,9 @@ static void s32k358_soc_realize(DeviceState *dev_soc, Error **errp) {
         return;
     }
 
+    /* Extra cycles per flash fetch, charged with icount-cycles */
+    memory_region_set_wait_states(&s->flash, s->flash_wait_states);
+
     /* Alias for flash memory for convenience in MMIO */
     memory_region_init_alias(&s->flash_alias, OBJECT(dev_soc),
                              "S32K358.flash.alias", &s->flash, 0,
@@ -136,10 +140,17 @@ static void s32k358_soc_realize(DeviceState *dev_soc, Error **errp) {
     }
 }
 
-// Class initialization: sets realize callback
+// SoC properties
+static Property s32k358_soc_properties[] = {
+    DEFINE_PROP_UINT8("flash-wait-states", S32K358State, flash_wait_states, 0),
+    DEFINE_PROP_END_OF_LIST(),
+};
+
+// Class initialization: sets realize callback and properties
 static void s32k358_soc_class_init(ObjectClass *klass, void *data) {
     DeviceClass *dc = DEVICE_CLASS(klass);
     dc->realize = s32k358_soc_realize;
+    device_class_set_props(dc, s32k358_soc_properties);
 }
 
 // Type information for S32K358 SoC
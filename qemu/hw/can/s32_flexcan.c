@@ -7,7 +7,10 @@
 static uint64_t flexcan_read(void *opaque, hwaddr addr, unsigned size)
 {
     FlexCANState *s = opaque;  // Cast opaque pointer to FlexCANState
-    (void)addr; (void)size;    // Suppress unused variable warnings
+    (void)size;                // Suppress unused variable warnings
+
+    // A driver waiting for a status bit would spin here forever: park it
+    poll_wait_read(&s->poll, addr, 0);
     return 0;                   // Stub: always return 0
 }
 
@@ -17,6 +20,8 @@ static void flexcan_write(void *opaque, hwaddr addr, uint64_t val, unsigned size
 {
     FlexCANState *s = opaque;
     (void)addr; (void)val; (void)size;
+
+    poll_wait_changed(&s->poll);
 }
 
 // Simulated reception of a CAN frame
@@ -24,6 +29,7 @@ static void flexcan_write(void *opaque, hwaddr addr, uint64_t val, unsigned size
 void flexcan_receive(FlexCANState *s, CanFrame *frame)
 {
     qemu_log("FlexCAN received frame ID=0x%03X DLC=%u\n", frame->id, frame->dlc);
+    poll_wait_changed(&s->poll); // Wake a CPU waiting for the frame
 }
 
 // Memory-mapped I/O operations for FlexCAN
@@ -51,6 +57,8 @@ static void flexcan_realize(DeviceState *dev, Error **errp)
     // Connect the MMIO region to the SysBusDevice
     sysbus_init_mmio(SYS_BUS_DEVICE(s), &s->mmio);
 
+    poll_wait_init(&s->poll);
+
     // Register the FlexCAN node on a logical CAN bus, if a bus is assigned
     if (s->bus) {
         can_bus_add_node(s->bus, s);
@@ -21,6 +21,16 @@
 
 #define DB_PRINT(fmt, args...) DB_PRINT_L(1, fmt, ## args)
 
+/* -------------------- Interrupt handling -------------------- */
+
+// Update the IRQ line: level-triggered on TDRE (if TIE) and RDRF (if RIE)
+static void s32k358_lpuart_update_irq(S32K358LPUARTState *s) {
+    bool level = ((s->ctrl & LPUART_CTRL_TIE) && (s->stat & LPUART_STAT_TDRE)) ||
+                 ((s->ctrl & LPUART_CTRL_RIE) && (s->stat & LPUART_STAT_RDRF));
+
+    qemu_set_irq(s->irq, level);
+}
+
 /* -------------------- Character Device Handlers -------------------- */
 
 // Check if the LPUART can receive data (used by chardev frontends)
@@ -40,7 +50,8 @@ static void s32k358_lpuart_receive(void *opaque, const uint8_t *buf, int size) {
 
     s->data = *buf;                  // Store received byte in DATA register
     s->stat |= LPUART_STAT_RDRF;     // Set "Receive Data Register Full" flag
-    qemu_set_irq(s->irq, 1);         // Trigger interrupt to CPU
+    s32k358_lpuart_update_irq(s);    // Trigger interrupt to CPU (if RIE)
+    poll_wait_changed(&s->poll);     // Wake a CPU spinning on RDRF
 }
 
 /* -------------------- Memory-mapped register access -------------------- */
@@ -48,27 +59,40 @@ static void s32k358_lpuart_receive(void *opaque, const uint8_t *buf, int size) {
 // Read handler for LPUART MMIO registers
 static uint64_t s32k358_lpuart_read(void *opaque, hwaddr addr, unsigned size) {
     S32K358LPUARTState *s = opaque;
+    uint64_t val;
 
     switch (addr) {
     case LPUART_BAUD:
-        return s->baud;
+        val = s->baud;
+        break;
     case LPUART_STAT:
-        return s->stat;
+        val = s->stat;
+        break;
     case LPUART_CTRL:
-        return s->ctrl;
+        val = s->ctrl;
+        break;
     case LPUART_DATA:
         s->stat &= ~LPUART_STAT_RDRF; // Clear RX flag after read
-        return s->data;
+        s32k358_lpuart_update_irq(s);
+        val = s->data;
+        break;
     default:
         qemu_log_mask(LOG_GUEST_ERROR, "[lpuart] - Invalid read offset: 0x%" HWADDR_PRIx "\n", addr);
-        return 0;
+        val = 0;
+        break;
     }
+
+    // Halt the CPU if it keeps reading the same value (e.g. waiting for RDRF)
+    poll_wait_read(&s->poll, addr, val);
+    return val;
 }
 
 // Write handler for LPUART MMIO registers
 static void s32k358_lpuart_write(void *opaque, hwaddr addr, uint64_t val, unsigned size) {
     S32K358LPUARTState *s = opaque;
 
+    poll_wait_changed(&s->poll);     // Any write may change what STAT reads
+
     switch (addr) {
     case LPUART_BAUD:
         s->baud = val;
@@ -78,6 +102,7 @@ static void s32k358_lpuart_write(void *opaque, hwaddr addr, uint64_t val, unsign
         if (s->ctrl & LPUART_CTRL_TE) {
             s->stat |= LPUART_STAT_TDRE; // Transmit Data Register Empty
         }
+        s32k358_lpuart_update_irq(s);    // TIE/RIE may have changed
         break;
     case LPUART_DATA:
         if (!(s->ctrl & LPUART_CTRL_TE)) {
@@ -87,6 +112,7 @@ static void s32k358_lpuart_write(void *opaque, hwaddr addr, uint64_t val, unsign
         // Send data to all connected chardev frontends
         qemu_chr_fe_write_all(&s->chr, (uint8_t *)&val, 1);
         s->stat |= LPUART_STAT_TDRE; // Set TDRE after sending
+        s32k358_lpuart_update_irq(s);
         break;
     default:
         qemu_log_mask(LOG_GUEST_ERROR, "Invalid write offset: 0x%" HWADDR_PRIx "\n", addr);
@@ -129,6 +155,8 @@ static void s32k358_lpuart_realize(DeviceState *dev, Error **errp) {
     s->baud = 0x1A0; // Example default baud rate
     s->data = 0;
 
+    poll_wait_init(&s->poll);
+
     // Setup chardev handlers for RX/TX
     qemu_chr_fe_set_handlers(&s->chr,
                              s32k358_lpuart_can_receive, // Can receive?
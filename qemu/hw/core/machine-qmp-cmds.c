@@ -382,6 +382,34 @@ static int qmp_x_query_intc_foreach(Object *obj, void *opaque)
     return 0;
 }
 
+static int qmp_x_query_irq_latency_foreach(Object *obj, void *opaque)
+{
+    InterruptStatsProviderClass *k;
+    GString *buf = opaque;
+
+    if (object_dynamic_cast(obj, TYPE_INTERRUPT_STATS_PROVIDER)) {
+        k = INTERRUPT_STATS_PROVIDER_GET_CLASS(obj);
+        if (k->print_irq_latency) {
+            k->print_irq_latency(INTERRUPT_STATS_PROVIDER(obj), buf);
+        }
+    }
+
+    return 0;
+}
+
+HumanReadableText *qmp_x_query_irq_latency(Error **errp)
+{
+    g_autoptr(GString) buf = g_string_new("");
+
+    object_child_foreach_recursive(object_get_root(),
+                                   qmp_x_query_irq_latency_foreach, buf);
+    if (!buf->len) {
+        g_string_append(buf, "No interrupt latency statistics available.\n");
+    }
+
+    return human_readable_text_from_str(buf);
+}
+
 HumanReadableText *qmp_x_query_interrupt_controllers(Error **errp)
 {
     g_autoptr(GString) buf = g_string_new("");
@@ -0,0 +1,97 @@
+/*
+ * Parking a CPU that busy-polls a device register
+ *
+ * This code is licensed under the GPL version 2 or later.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "qemu/osdep.h"
+#include "hw/core/poll-wait.h"
+#include "hw/core/cpu.h"
+#include "sysemu/replay.h"
+#include "sysemu/runstate.h"
+#include "sysemu/tcg.h"
+
+bool poll_wait_enabled;
+
+static void poll_wait_wake(PollWait *pw)
+{
+    CPUState *cpu = pw->waiter;
+
+    pw->count = 0;
+    if (cpu) {
+        /*
+         * If the CPU was woken by an interrupt meanwhile and has since
+         * executed WFI, this ends that WFI early, which is allowed.
+         */
+        pw->waiter = NULL;
+        timer_del(pw->timer);
+        cpu->halted = 0;
+        qemu_cpu_kick(cpu);
+    }
+}
+
+static void poll_wait_timeout(void *opaque)
+{
+    poll_wait_wake(opaque);
+}
+
+/*
+ * Neither the waiter nor the timer are part of any device's migration
+ * state, while the halted flag of the CPU is. Wake the CPU whenever the
+ * VM stops, which it does before its state is saved for migration or a
+ * snapshot, so that no CPU is ever saved halted on our behalf.
+ */
+static void poll_wait_vm_state_change(void *opaque, bool running,
+                                      RunState state)
+{
+    if (!running) {
+        poll_wait_wake(opaque);
+    }
+}
+
+void poll_wait_init(PollWait *pw)
+{
+    pw->timer = timer_new_ns(QEMU_CLOCK_VIRTUAL, poll_wait_timeout, pw);
+    pw->waiter = NULL;
+    pw->count = 0;
+    qemu_add_vm_change_state_handler(poll_wait_vm_state_change, pw);
+}
+
+void poll_wait_read(PollWait *pw, hwaddr addr, uint64_t value)
+{
+    CPUState *cpu = current_cpu;
+
+    /* Record/replay needs the guest to see exactly the recorded reads */
+    if (!poll_wait_enabled || !cpu || !tcg_enabled() ||
+        replay_mode != REPLAY_MODE_NONE) {
+        return;
+    }
+
+    if (pw->count == 0 || addr != pw->addr || value != pw->value) {
+        pw->addr = addr;
+        pw->value = value;
+        pw->count = 1;
+        return;
+    }
+    if (++pw->count < POLL_WAIT_READS) {
+        return;
+    }
+
+    /*
+     * The CPU finishes the current TB and then stays halted until
+     * poll_wait_changed(), an interrupt or the timeout.
+     */
+    pw->count = 0;
+    pw->waiter = cpu;
+    cpu->halted = 1;
+    cpu_exit(cpu);
+    timer_mod(pw->timer,
+              qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) + POLL_WAIT_TIMEOUT_NS);
+}
+
+void poll_wait_changed(PollWait *pw)
+{
+    poll_wait_wake(pw);
+}
@@ -20,12 +20,16 @@
 #include "hw/qdev-properties.h"
 #include "sysemu/tcg.h"
 #include "sysemu/runstate.h"
+#include "sysemu/cpu-timers.h"
 #include "target/arm/cpu.h"
 #include "target/arm/cpu-features.h"
 #include "exec/exec-all.h"
 #include "exec/memop.h"
 #include "qemu/log.h"
 #include "qemu/module.h"
+#include "qemu/bitmap.h"
+#include "qemu/atomic.h"
+#include "hw/intc/intc.h"
 #include "trace.h"
 
 /* IRQ number counting:
@@ -80,6 +84,51 @@ static void signal_sysresetreq(NVICState *s)
     }
 }
 
+/* Copy the enabled/pending/active flags of vectors[irq] into the
+ * external interrupt bitmaps. Must be called after changing any of
+ * those flags for an external interrupt; internal exceptions are not
+ * tracked in the bitmaps, so calling this for them is a no-op.
+ */
+static void nvic_sync_ext_irq(NVICState *s, int irq)
+{
+    VecInfo *vec = &s->vectors[irq];
+    long n = irq - NVIC_FIRST_IRQ;
+
+    if (irq < NVIC_FIRST_IRQ) {
+        return;
+    }
+
+    if (vec->enabled) {
+        set_bit(n, s->ext_enabled);
+    } else {
+        clear_bit(n, s->ext_enabled);
+    }
+    if (vec->pending) {
+        set_bit(n, s->ext_pending);
+    } else {
+        clear_bit(n, s->ext_pending);
+    }
+    if (vec->active) {
+        set_bit(n, s->ext_active);
+    } else {
+        clear_bit(n, s->ext_active);
+    }
+}
+
+/* Recompute the external interrupt bitmaps from scratch (reset, migration) */
+static void nvic_rebuild_ext_irqs(NVICState *s)
+{
+    int irq;
+
+    bitmap_zero(s->ext_enabled, NVIC_MAX_EXT_IRQS);
+    bitmap_zero(s->ext_pending, NVIC_MAX_EXT_IRQS);
+    bitmap_zero(s->ext_active, NVIC_MAX_EXT_IRQS);
+
+    for (irq = NVIC_FIRST_IRQ; irq < s->num_irq; irq++) {
+        nvic_sync_ext_irq(s, irq);
+    }
+}
+
 static int nvic_pending_prio(NVICState *s)
 {
     /* return the group priority of the current pending interrupt,
@@ -107,10 +156,9 @@ static bool nvic_rettobase(NVICState *s)
     int irq, nhand = 0;
     bool check_sec = arm_feature(&s->cpu->env, ARM_FEATURE_M_SECURITY);
 
-    for (irq = ARMV7M_EXCP_RESET; irq < s->num_irq; irq++) {
+    for (irq = ARMV7M_EXCP_RESET; irq < NVIC_FIRST_IRQ; irq++) {
         if (s->vectors[irq].active ||
-            (check_sec && irq < NVIC_INTERNAL_VECTORS &&
-             s->sec_vectors[irq].active)) {
+            (check_sec && s->sec_vectors[irq].active)) {
             nhand++;
             if (nhand == 2) {
                 return 0;
@@ -118,7 +166,10 @@ static bool nvic_rettobase(NVICState *s)
         }
     }
 
-    return 1;
+    /* External interrupts are never banked */
+    nhand += bitmap_count_one(s->ext_active, s->num_irq - NVIC_FIRST_IRQ);
+
+    return nhand < 2;
 }
 
 /* Return the value of the ISCR ISRPENDING bit:
@@ -127,23 +178,16 @@ static bool nvic_rettobase(NVICState *s)
  */
 static bool nvic_isrpending(NVICState *s)
 {
-    int irq;
-
     /*
      * We can shortcut if the highest priority pending interrupt
-     * happens to be external; if not we need to check the whole
-     * vectors[] array.
+     * happens to be external; if not we need to check the
+     * pending bitmap.
      */
     if (s->vectpending > NVIC_FIRST_IRQ) {
         return true;
     }
 
-    for (irq = NVIC_FIRST_IRQ; irq < s->num_irq; irq++) {
-        if (s->vectors[irq].pending) {
-            return true;
-        }
-    }
-    return false;
+    return !bitmap_empty(s->ext_pending, s->num_irq - NVIC_FIRST_IRQ);
 }
 
 static bool exc_is_banked(int exc)
@@ -289,7 +333,7 @@ static void nvic_recompute_state_secure(NVICState *s)
 /* Recompute vectpending and exception_prio */
 static void nvic_recompute_state(NVICState *s)
 {
-    int i;
+    int i, w;
     int pend_prio = NVIC_NOEXC_PRIO;
     int active_prio = NVIC_NOEXC_PRIO;
     int pend_irq = 0;
@@ -306,7 +350,7 @@ static void nvic_recompute_state(NVICState *s)
         return;
     }
 
-    for (i = 1; i < s->num_irq; i++) {
+    for (i = 1; i < NVIC_FIRST_IRQ; i++) {
         VecInfo *vec = &s->vectors[i];
 
         if (vec->enabled && vec->pending && vec->prio < pend_prio) {
@@ -318,6 +362,32 @@ static void nvic_recompute_state(NVICState *s)
         }
     }
 
+    /* For external interrupts only visit the set bits of the bitmaps,
+     * in ascending exception number order so that the lowest numbered
+     * interrupt still wins among equal priorities.
+     */
+    for (w = 0; w < BITS_TO_LONGS(s->num_irq - NVIC_FIRST_IRQ); w++) {
+        unsigned long bits = s->ext_pending[w] & s->ext_enabled[w];
+
+        while (bits) {
+            i = NVIC_FIRST_IRQ + w * BITS_PER_LONG + ctzl(bits);
+            if (s->vectors[i].prio < pend_prio) {
+                pend_prio = s->vectors[i].prio;
+                pend_irq = i;
+            }
+            bits &= bits - 1;
+        }
+
+        bits = s->ext_active[w];
+        while (bits) {
+            i = NVIC_FIRST_IRQ + w * BITS_PER_LONG + ctzl(bits);
+            if (s->vectors[i].prio < active_prio) {
+                active_prio = s->vectors[i].prio;
+            }
+            bits &= bits - 1;
+        }
+    }
+
     if (active_prio > 0) {
         active_prio &= nvic_gprio_mask(s, false);
     }
@@ -466,18 +536,13 @@ static int get_prio(NVICState *s, unsigned irq, bool secure)
     }
 }
 
-/* Recompute state and assert irq line accordingly.
- * Must be called after changes to:
- *  vec->active, vec->enabled, vec->pending or vec->prio for any vector
- *  prigroup
+/* Raise or lower the NVIC output line from the cached vectpending and
+ * exception_prio state.
  */
-static void nvic_irq_update(NVICState *s)
+static void nvic_irq_drive_output(NVICState *s)
 {
     int lvl;
-    int pend_prio;
-
-    nvic_recompute_state(s);
-    pend_prio = nvic_pending_prio(s);
+    int pend_prio = nvic_pending_prio(s);
 
     /* Raise NVIC output if this IRQ would be taken, except that we
      * ignore the effects of the BASEPRI, FAULTMASK and PRIMASK (which
@@ -490,6 +555,124 @@ static void nvic_irq_update(NVICState *s)
     qemu_set_irq(s->excpout, lvl);
 }
 
+/* Recompute state and assert irq line accordingly.
+ * Must be called after changes to:
+ *  vec->active, vec->enabled, vec->pending or vec->prio for any vector
+ *  prigroup
+ */
+static void nvic_irq_update(NVICState *s)
+{
+    nvic_recompute_state(s);
+    nvic_irq_drive_output(s);
+}
+
+/* Update state and irq line after vector @irq (in the non-banked
+ * vectors[] array) has just become pending, with no other change.
+ * This is the hot path for PendSV requests from an RTOS and for
+ * SysTick and peripheral interrupts, so rather than rescanning every
+ * vector we only compare the new exception against the current
+ * vectpending: exception_prio cannot change, and the recompute picks
+ * the lowest numbered exception among those of equal priority.
+ * If the new exception does not displace vectpending then nothing
+ * the irq line depends on has changed and we leave it alone.
+ * With the Security Extension we just do the full update.
+ */
+static void nvic_irq_pended(NVICState *s, int irq)
+{
+    VecInfo *vec = &s->vectors[irq];
+    int cur_prio;
+
+    if (arm_feature(&s->cpu->env, ARM_FEATURE_M_SECURITY)) {
+        nvic_irq_update(s);
+        return;
+    }
+
+    if (!vec->enabled) {
+        return;
+    }
+
+    cur_prio = s->vectpending ? s->vectors[s->vectpending].prio
+                              : NVIC_NOEXC_PRIO;
+    if (vec->prio > cur_prio ||
+        (vec->prio == cur_prio && irq > s->vectpending)) {
+        return;
+    }
+
+    s->vectpending = irq;
+    s->vectpending_prio = vec->prio;
+    if (vec->prio > 0) {
+        s->vectpending_prio &= nvic_gprio_mask(s, false);
+    }
+    trace_nvic_recompute_state(s->vectpending,
+                               s->vectpending_prio,
+                               s->exception_prio);
+
+    nvic_irq_drive_output(s);
+}
+
+/*
+ * Interrupt latency statistics. We timestamp an exception when it
+ * becomes pending and when its handler is entered, and add the deltas
+ * to power-of-two histograms when the handler is entered and when it
+ * returns. Recording is a clock read and a counter increment, cheap
+ * enough to leave on all the time; the counters are only ever
+ * incremented atomically, so they can be read at any point without
+ * taking a lock.
+ */
+static int64_t nvic_latency_insns(void)
+{
+    /* Instruction counts are only available with icount */
+    return icount_enabled() ? icount_get_raw() : 0;
+}
+
+static void nvic_latency_add(NVICLatencyHist *h, int64_t delta)
+{
+    int bucket = delta > 0 ? 64 - clz64(delta) : 0;
+
+    qatomic_inc(&h->count[MIN(bucket, NVIC_LATENCY_BUCKETS - 1)]);
+}
+
+static void nvic_latency_pended(NVICState *s, int irq)
+{
+    NVICIRQLatency *l = &s->latency[irq];
+
+    l->pend_ns = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    l->pend_insns = nvic_latency_insns();
+}
+
+static void nvic_latency_unpended(NVICState *s, int irq)
+{
+    /* Pended again later, the exception is measured from then */
+    s->latency[irq].pend_ns = -1;
+}
+
+static void nvic_latency_acknowledged(NVICState *s, int irq)
+{
+    NVICIRQLatency *l = &s->latency[irq];
+
+    l->active_ns = qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+    l->active_insns = nvic_latency_insns();
+    if (l->pend_ns >= 0) {
+        nvic_latency_add(&l->entry_ns, l->active_ns - l->pend_ns);
+        nvic_latency_add(&l->entry_insns, l->active_insns - l->pend_insns);
+        l->pend_ns = -1;
+    }
+    qatomic_inc(&s->irq_counts[irq]);
+}
+
+static void nvic_latency_completed(NVICState *s, int irq)
+{
+    NVICIRQLatency *l = &s->latency[irq];
+
+    if (l->active_ns >= 0) {
+        nvic_latency_add(&l->handler_ns,
+                         qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL) - l->active_ns);
+        nvic_latency_add(&l->handler_insns,
+                         nvic_latency_insns() - l->active_insns);
+        l->active_ns = -1;
+    }
+}
+
 /**
  * armv7m_nvic_clear_pending: mark the specified exception as not pending
  * @opaque: the NVIC
@@ -517,6 +700,8 @@ static void armv7m_nvic_clear_pending(NVICState *s, int irq, bool secure)
     trace_nvic_clear_pending(irq, secure, vec->enabled, vec->prio);
     if (vec->pending) {
         vec->pending = 0;
+        nvic_sync_ext_irq(s, irq);
+        nvic_latency_unpended(s, irq);
         nvic_irq_update(s);
     }
 }
@@ -657,7 +842,9 @@ static void do_armv7m_nvic_set_pending(void *opaque, int irq, bool secure,
 
     if (!vec->pending) {
         vec->pending = 1;
-        nvic_irq_update(s);
+        nvic_sync_ext_irq(s, irq);
+        nvic_latency_pended(s, irq);
+        nvic_irq_pended(s, irq);
     }
 }
 
@@ -754,6 +941,7 @@ void armv7m_nvic_set_pending_lazyfp(NVICState *s, int irq, bool secure)
     }
     if (!vec->pending) {
         vec->pending = 1;
+        nvic_latency_pended(s, irq);
         /*
          * We do not call nvic_irq_update(), because we know our caller
          * is going to handle causing us to take the exception by
@@ -791,6 +979,8 @@ void armv7m_nvic_acknowledge_irq(NVICState *s)
 
     vec->active = 1;
     vec->pending = 0;
+    nvic_sync_ext_irq(s, pending);
+    nvic_latency_acknowledged(s, pending);
 
     write_v7m_exception(env, s->vectpending);
 
@@ -888,6 +1078,10 @@ int armv7m_nvic_complete_irq(NVICState *s, int irq, bool secure)
         }
     }
 
+    if (ret >= 0) {
+        nvic_latency_completed(s, irq);
+    }
+
     if (!vec) {
         return ret;
     }
@@ -899,7 +1093,9 @@ int armv7m_nvic_complete_irq(NVICState *s, int irq, bool secure)
          */
         assert(irq >= NVIC_FIRST_IRQ);
         vec->pending = 1;
+        nvic_latency_pended(s, irq);
     }
+    nvic_sync_ext_irq(s, irq);
 
     nvic_irq_update(s);
 
@@ -1550,6 +1746,75 @@ static uint32_t nvic_readl(NVICState *s, uint32_t offset, MemTxAttrs attrs)
     }
 }
 
+/* All M-profile MMU indexes, for TLB flushes after MPU changes */
+#define NVIC_MPU_MMUIDX_BITS \
+    (ARMMMUIdxBit_MUser | ARMMMUIdxBit_MPriv | \
+     ARMMMUIdxBit_MUserNegPri | ARMMMUIdxBit_MPrivNegPri | \
+     ARMMMUIdxBit_MSUser | ARMMMUIdxBit_MSPriv | \
+     ARMMMUIdxBit_MSUserNegPri | ARMMMUIdxBit_MSPrivNegPri)
+
+/* Return the range of addresses that MPU region @region can match,
+ * or false if it matches none (it is disabled, or invalid in a way
+ * which makes the MPU lookup ignore it).
+ */
+static bool nvic_mpu_region_range(ARMCPU *cpu, int region, bool secure,
+                                  uint64_t *base, uint64_t *size)
+{
+    CPUARMState *env = &cpu->env;
+
+    if (arm_feature(env, ARM_FEATURE_V8)) {
+        uint32_t rlar = env->pmsav8.rlar[secure][region];
+        uint32_t limit = rlar | 0x1f;
+
+        *base = env->pmsav8.rbar[secure][region] & ~0x1f;
+        if (!(rlar & 1) || *base > limit) {
+            return false;
+        }
+        *size = limit - *base + 1;
+    } else {
+        uint32_t drsr = env->pmsav7.drsr[region];
+        uint32_t rsize = extract32(drsr, 1, 5);
+
+        if (!(drsr & 1) || !rsize) {
+            return false;
+        }
+        *base = env->pmsav7.drbar[region];
+        *size = 1ULL << (rsize + 1);
+        if (*base & (*size - 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Flush the TLB entries that MPU region @region can affect. Changing a
+ * region only changes the result of lookups for addresses it covered
+ * before or covers afterwards (and for the rest of the pages holding
+ * them), so callers invoke this both before and after the update
+ * instead of flushing the whole TLB. RTOSes that reprogram a few
+ * regions on every context switch then keep the TLB entries for the
+ * rest of the address space.
+ */
+static void nvic_mpu_region_flush(ARMCPU *cpu, int region, bool secure)
+{
+    CPUState *cs = CPU(cpu);
+    uint64_t base, size, start, end;
+
+    if (!nvic_mpu_region_range(cpu, region, secure, &base, &size)) {
+        return;
+    }
+    if (!qemu_cpu_is_self(cs)) {
+        /* e.g. a debugger access: the ranged flush must run on the vCPU */
+        tlb_flush(cs);
+        return;
+    }
+
+    start = base & TARGET_PAGE_MASK;
+    end = ROUND_UP(base + size, TARGET_PAGE_SIZE);
+    tlb_flush_range_by_mmuidx(cs, start, end - start, NVIC_MPU_MMUIDX_BITS,
+                              TARGET_LONG_BITS);
+}
+
 static void nvic_writel(NVICState *s, uint32_t offset, uint32_t value,
                         MemTxAttrs attrs)
 {
@@ -1834,11 +2099,13 @@ static void nvic_writel(NVICState *s, uint32_t offset, uint32_t value,
             qemu_log_mask(LOG_GUEST_ERROR, "MPU_CTRL: HFNMIENA and !ENABLE is "
                           "UNPREDICTABLE\n");
         }
-        cpu->env.v7m.mpu_ctrl[attrs.secure]
-            = value & (R_V7M_MPU_CTRL_ENABLE_MASK |
-                       R_V7M_MPU_CTRL_HFNMIENA_MASK |
-                       R_V7M_MPU_CTRL_PRIVDEFENA_MASK);
-        tlb_flush(CPU(cpu));
+        value &= (R_V7M_MPU_CTRL_ENABLE_MASK |
+                  R_V7M_MPU_CTRL_HFNMIENA_MASK |
+                  R_V7M_MPU_CTRL_PRIVDEFENA_MASK);
+        if (cpu->env.v7m.mpu_ctrl[attrs.secure] != value) {
+            cpu->env.v7m.mpu_ctrl[attrs.secure] = value;
+            tlb_flush(CPU(cpu));
+        }
         break;
     case 0xd98: /* MPU_RNR */
         if (value >= cpu->pmsav7_dregion) {
@@ -1871,8 +2138,11 @@ static void nvic_writel(NVICState *s, uint32_t offset, uint32_t value,
             if (region >= cpu->pmsav7_dregion) {
                 return;
             }
-            cpu->env.pmsav8.rbar[attrs.secure][region] = value;
-            tlb_flush(CPU(cpu));
+            if (cpu->env.pmsav8.rbar[attrs.secure][region] != value) {
+                nvic_mpu_region_flush(cpu, region, attrs.secure);
+                cpu->env.pmsav8.rbar[attrs.secure][region] = value;
+                nvic_mpu_region_flush(cpu, region, attrs.secure);
+            }
             return;
         }
 
@@ -1896,8 +2166,11 @@ static void nvic_writel(NVICState *s, uint32_t offset, uint32_t value,
             return;
         }
 
-        cpu->env.pmsav7.drbar[region] = value & ~0x1f;
-        tlb_flush(CPU(cpu));
+        if (cpu->env.pmsav7.drbar[region] != (value & ~0x1f)) {
+            nvic_mpu_region_flush(cpu, region, attrs.secure);
+            cpu->env.pmsav7.drbar[region] = value & ~0x1f;
+            nvic_mpu_region_flush(cpu, region, attrs.secure);
+        }
         break;
     }
     case 0xda0: /* MPU_RASR (v7M), MPU_RLAR (v8M) */
@@ -1921,8 +2194,11 @@ static void nvic_writel(NVICState *s, uint32_t offset, uint32_t value,
             if (region >= cpu->pmsav7_dregion) {
                 return;
             }
-            cpu->env.pmsav8.rlar[attrs.secure][region] = value;
-            tlb_flush(CPU(cpu));
+            if (cpu->env.pmsav8.rlar[attrs.secure][region] != value) {
+                nvic_mpu_region_flush(cpu, region, attrs.secure);
+                cpu->env.pmsav8.rlar[attrs.secure][region] = value;
+                nvic_mpu_region_flush(cpu, region, attrs.secure);
+            }
             return;
         }
 
@@ -1930,9 +2206,13 @@ static void nvic_writel(NVICState *s, uint32_t offset, uint32_t value,
             return;
         }
 
-        cpu->env.pmsav7.drsr[region] = value & 0xff3f;
-        cpu->env.pmsav7.dracr[region] = (value >> 16) & 0x173f;
-        tlb_flush(CPU(cpu));
+        if (cpu->env.pmsav7.drsr[region] != (value & 0xff3f) ||
+            cpu->env.pmsav7.dracr[region] != ((value >> 16) & 0x173f)) {
+            nvic_mpu_region_flush(cpu, region, attrs.secure);
+            cpu->env.pmsav7.drsr[region] = value & 0xff3f;
+            cpu->env.pmsav7.dracr[region] = (value >> 16) & 0x173f;
+            nvic_mpu_region_flush(cpu, region, attrs.secure);
+        }
         break;
     }
     case 0xdc0: /* MPU_MAIR0 */
@@ -2364,6 +2644,7 @@ static MemTxResult nvic_sysreg_write(void *opaque, hwaddr addr,
             if (value & (1 << i) &&
                 (attrs.secure || s->itns[startvec + i])) {
                 s->vectors[startvec + i].enabled = setval;
+                nvic_sync_ext_irq(s, startvec + i);
             }
         }
         nvic_irq_update(s);
@@ -2388,7 +2669,13 @@ static MemTxResult nvic_sysreg_write(void *opaque, hwaddr addr,
                 (attrs.secure || s->itns[startvec + i]) &&
                 !(setval == 0 && s->vectors[startvec + i].level &&
                   !s->vectors[startvec + i].active)) {
+                if (!setval) {
+                    nvic_latency_unpended(s, startvec + i);
+                } else if (!s->vectors[startvec + i].pending) {
+                    nvic_latency_pended(s, startvec + i);
+                }
                 s->vectors[startvec + i].pending = setval;
+                nvic_sync_ext_irq(s, startvec + i);
             }
         }
         nvic_irq_update(s);
@@ -2489,6 +2776,7 @@ static int nvic_post_load(void *opaque, int version_id)
         }
     }
 
+    nvic_rebuild_ext_irqs(s);
     nvic_recompute_state(s);
 
     return 0;
@@ -2582,7 +2870,7 @@ static Property props_nvic[] = {
 
 static void armv7m_nvic_reset(DeviceState *dev)
 {
-    int resetprio;
+    int resetprio, i;
     NVICState *s = NVIC(dev);
 
     memset(s->vectors, 0, sizeof(s->vectors));
@@ -2630,6 +2918,13 @@ static void armv7m_nvic_reset(DeviceState *dev)
     s->vectpending = 0;
     s->vectpending_is_s_banked = false;
     s->vectpending_prio = NVIC_NOEXC_PRIO;
+    nvic_rebuild_ext_irqs(s);
+
+    /* Keep the accumulated latency statistics, but drop the timestamps */
+    for (i = 0; i < s->num_irq; i++) {
+        s->latency[i].pend_ns = -1;
+        s->latency[i].active_ns = -1;
+    }
 
     if (arm_feature(&s->cpu->env, ARM_FEATURE_M_SECURITY)) {
         memset(s->itns, 0, sizeof(s->itns));
@@ -2638,8 +2933,6 @@ static void armv7m_nvic_reset(DeviceState *dev)
          * NVIC; we set the bits to true to avoid having to do a feature
          * bit check in the NVIC enable/pend/etc register accessors.
          */
-        int i;
-
         for (i = NVIC_FIRST_IRQ; i < ARRAY_SIZE(s->itns); i++) {
             s->itns[i] = true;
         }
@@ -2716,6 +3009,95 @@ static void armv7m_nvic_realize(DeviceState *dev, Error **errp)
     memory_region_init_io(&s->sysregmem, OBJECT(s), &nvic_sysreg_ops, s,
                           "nvic_sysregs", 0x1000);
     sysbus_init_mmio(SYS_BUS_DEVICE(dev), &s->sysregmem);
+
+    s->latency = g_new0(NVICIRQLatency, s->num_irq);
+    s->irq_counts = g_new0(uint64_t, s->num_irq);
+}
+
+static bool armv7m_nvic_get_statistics(InterruptStatsProvider *obj,
+                                       uint64_t **irq_counts,
+                                       unsigned int *nb_irqs)
+{
+    NVICState *s = NVIC(obj);
+
+    *irq_counts = s->irq_counts;
+    *nb_irqs = s->num_irq;
+    return true;
+}
+
+static void nvic_print_latency_hist(GString *buf, const char *unit,
+                                    NVICLatencyHist *h)
+{
+    int i;
+    uint32_t count;
+
+    g_string_append_printf(buf, "    %-6s", unit);
+    for (i = 0; i < NVIC_LATENCY_BUCKETS; i++) {
+        count = qatomic_read(&h->count[i]);
+        if (!count) {
+            continue;
+        }
+        if (i == 0) {
+            g_string_append_printf(buf, " 0:%u", count);
+        } else if (i == NVIC_LATENCY_BUCKETS - 1) {
+            g_string_append_printf(buf, " >=%" PRIu64 ":%u",
+                                   1ULL << (i - 1), count);
+        } else {
+            g_string_append_printf(buf, " <%" PRIu64 ":%u", 1ULL << i, count);
+        }
+    }
+    g_string_append_c(buf, '\n');
+}
+
+static uint64_t nvic_latency_samples(NVICLatencyHist *h)
+{
+    uint64_t total = 0;
+    int i;
+
+    for (i = 0; i < NVIC_LATENCY_BUCKETS; i++) {
+        total += qatomic_read(&h->count[i]);
+    }
+    return total;
+}
+
+static void armv7m_nvic_print_irq_latency(InterruptStatsProvider *obj,
+                                          GString *buf)
+{
+    NVICState *s = NVIC(obj);
+    bool insns = icount_enabled();
+    uint64_t entries, handlers;
+    int irq;
+
+    g_string_append_printf(buf, "Interrupt latency for %s "
+                           "(log2 histograms, bucket upper bound:count):\n",
+                           object_get_canonical_path(OBJECT(s)));
+    for (irq = ARMV7M_EXCP_NMI; irq < s->num_irq; irq++) {
+        NVICIRQLatency *l = &s->latency[irq];
+
+        entries = nvic_latency_samples(&l->entry_ns);
+        handlers = nvic_latency_samples(&l->handler_ns);
+        if (!entries && !handlers) {
+            continue;
+        }
+        if (irq >= NVIC_FIRST_IRQ) {
+            g_string_append_printf(buf, "  exception %d (IRQ %d):\n",
+                                   irq, irq - NVIC_FIRST_IRQ);
+        } else {
+            g_string_append_printf(buf, "  exception %d:\n", irq);
+        }
+        g_string_append_printf(buf, "   pend to handler: %" PRIu64
+                               " samples\n", entries);
+        nvic_print_latency_hist(buf, "ns", &l->entry_ns);
+        if (insns) {
+            nvic_print_latency_hist(buf, "insns", &l->entry_insns);
+        }
+        g_string_append_printf(buf, "   handler duration: %" PRIu64
+                               " samples\n", handlers);
+        nvic_print_latency_hist(buf, "ns", &l->handler_ns);
+        if (insns) {
+            nvic_print_latency_hist(buf, "insns", &l->handler_insns);
+        }
+    }
 }
 
 static void armv7m_nvic_instance_init(Object *obj)
@@ -2734,11 +3116,14 @@ static void armv7m_nvic_instance_init(Object *obj)
 static void armv7m_nvic_class_init(ObjectClass *klass, void *data)
 {
     DeviceClass *dc = DEVICE_CLASS(klass);
+    InterruptStatsProviderClass *ic = INTERRUPT_STATS_PROVIDER_CLASS(klass);
 
     dc->vmsd  = &vmstate_nvic;
     device_class_set_props(dc, props_nvic);
     device_class_set_legacy_reset(dc, armv7m_nvic_reset);
     dc->realize = armv7m_nvic_realize;
+    ic->get_statistics = armv7m_nvic_get_statistics;
+    ic->print_irq_latency = armv7m_nvic_print_irq_latency;
 }
 
 static const TypeInfo armv7m_nvic_info = {
@@ -2748,6 +3133,10 @@ static const TypeInfo armv7m_nvic_info = {
     .instance_size = sizeof(NVICState),
     .class_init    = armv7m_nvic_class_init,
     .class_size    = sizeof(SysBusDeviceClass),
+    .interfaces    = (InterfaceInfo[]) {
+        { TYPE_INTERRUPT_STATS_PROVIDER },
+        { }
+    },
 };
 
 static void armv7m_nvic_register_types(void)
@@ -0,0 +1,499 @@
+/*
+ * ARMv7-M Data Watchpoint and Trace (DWT) unit
+ *
+ * This code is licensed under the GPL version 2 or later.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "qemu/osdep.h"
+#include "hw/misc/armv7m_dwt.h"
+#include "exec/memory.h"
+#include "exec/exec-all.h"
+#include "hw/qdev-clock.h"
+#include "hw/qdev-properties.h"
+#include "hw/registerfields.h"
+#include "migration/vmstate.h"
+#include "qapi/error.h"
+#include "qemu/log.h"
+#include "qemu/module.h"
+#include "qemu/timer.h"
+#include "sysemu/cpu-timers.h"
+#include "sysemu/tcg.h"
+#include "target/arm/cpu.h"
+
+REG32(DWT_CTRL, 0x0)
+    FIELD(DWT_CTRL, CYCCNTENA, 0, 1)
+    FIELD(DWT_CTRL, NOPRFCNT, 24, 1)
+    FIELD(DWT_CTRL, NOCYCCNT, 25, 1)
+    FIELD(DWT_CTRL, NOEXTTRIG, 26, 1)
+    FIELD(DWT_CTRL, NOTRCPKT, 27, 1)
+    FIELD(DWT_CTRL, NUMCOMP, 28, 4)
+REG32(DWT_CYCCNT, 0x4)
+REG32(DWT_CPICNT, 0x8)
+REG32(DWT_EXCCNT, 0xc)
+REG32(DWT_SLEEPCNT, 0x10)
+REG32(DWT_LSUCNT, 0x14)
+REG32(DWT_FOLDCNT, 0x18)
+REG32(DWT_PCSR, 0x1c)
+/* Comparator n is at DWT_COMP0 + 16 * n */
+REG32(DWT_COMP0, 0x20)
+REG32(DWT_MASK0, 0x24)
+REG32(DWT_FUNCTION0, 0x28)
+    FIELD(DWT_FUNCTION0, FUNCTION, 0, 4)
+    FIELD(DWT_FUNCTION0, CYCMATCH, 7, 1)
+    FIELD(DWT_FUNCTION0, DATAVMATCH, 8, 1)
+    FIELD(DWT_FUNCTION0, MATCHED, 24, 1)
+
+/* Writable DWT_CTRL bits: the counter and event enables and their taps */
+#define DWT_CTRL_WRITABLE 0x007f1fff
+/* Writable DWT_FUNCTIONn bits */
+#define DWT_FUNCTION_WRITABLE 0x000ffdaf
+
+/* DWT_FUNCTIONn.FUNCTION values for data address watchpoints */
+#define DWT_FUNCTION_WATCH_READ 5
+#define DWT_FUNCTION_WATCH_WRITE 6
+#define DWT_FUNCTION_WATCH_RW 7
+
+/* Peripheral and component ID registers, from 0xfd0 */
+static const uint8_t dwt_id[] = {
+    0x04, 0x00, 0x00, 0x00, /* PID4..PID7 */
+    0x02, 0xb0, 0x3b, 0x00, /* PID0..PID3 */
+    0x0d, 0xe0, 0x05, 0xb1, /* CID0..CID3 */
+};
+
+/*
+ * CYCCNT counts instructions when icount is enabled (an approximation
+ * of one cycle per instruction, but deterministic), and otherwise
+ * cycles of the CPU clock derived from QEMU_CLOCK_VIRTUAL.
+ */
+static int64_t dwt_now(void)
+{
+    if (icount_enabled()) {
+        return icount_get_raw();
+    }
+    return qemu_clock_get_ns(QEMU_CLOCK_VIRTUAL);
+}
+
+static uint32_t dwt_get_cyccnt(ARMv7MDWT *s)
+{
+    int64_t delta;
+
+    if (!FIELD_EX32(s->ctrl, DWT_CTRL, CYCCNTENA)) {
+        return s->cyccnt;
+    }
+
+    delta = dwt_now() - s->cyccnt_start;
+    if (!icount_enabled()) {
+        delta = clock_ns_to_ticks(s->cpuclk, delta);
+    }
+    /* The counter wraps, so only the low 32 bits matter */
+    return s->cyccnt + (uint32_t)delta;
+}
+
+/* Set CYCCNT to @value and restart counting from now */
+static void dwt_set_cyccnt(ARMv7MDWT *s, uint32_t value)
+{
+    s->cyccnt = value;
+    s->cyccnt_start = dwt_now();
+}
+
+static void dwt_cpuclk_update(void *opaque, ClockEvent event)
+{
+    ARMv7MDWT *s = ARMV7M_DWT(opaque);
+
+    /* Account for the cycles counted at the old frequency */
+    dwt_set_cyccnt(s, dwt_get_cyccnt(s));
+}
+
+/* How far either side of an instruction LDR (literal) can load from */
+#define DWT_LITERAL_REACH 0x1008
+
+/*
+ * The translator folds literal loads from ROM into the TB while no
+ * watchpoint is set, so that they never reach the watchpoint code.
+ * New TBs see the watchpoint in their TB flags, but existing ones,
+ * chained to each other, could keep running without a lookup.
+ * Invalidate those that could load a literal from [@start, @last].
+ */
+static void dwt_invalidate_literal_tbs(CPUState *cs, vaddr start, vaddr last)
+{
+    hwaddr addr = start > DWT_LITERAL_REACH ? start - DWT_LITERAL_REACH : 0;
+    hwaddr end = MIN(last + DWT_LITERAL_REACH, (hwaddr)UINT32_MAX);
+
+    RCU_READ_LOCK_GUARD();
+
+    while (addr <= end) {
+        hwaddr len = end - addr + 1;
+        hwaddr xlat;
+        MemoryRegion *mr;
+
+        mr = address_space_translate(cs->as, addr, &xlat, &len, false,
+                                     MEMTXATTRS_UNSPECIFIED);
+        if (memory_region_is_ram(mr)) {
+            ram_addr_t ram_addr = memory_region_get_ram_addr(mr) + xlat;
+
+            tb_invalidate_phys_range(ram_addr, ram_addr + len - 1);
+        }
+        addr += len;
+    }
+}
+
+/* (Re)insert the CPU watchpoint implementing comparator @n */
+static void dwt_update_comparator(ARMv7MDWT *s, int n)
+{
+    ARMv7MDWTComparator *c = &s->comparator[n];
+    CPUState *cs = CPU(s->cpu);
+    vaddr len;
+    int flags;
+
+    if (!tcg_enabled()) {
+        return;
+    }
+
+    if (c->wp) {
+        cpu_watchpoint_remove_by_ref(cs, c->wp);
+        c->wp = NULL;
+    }
+
+    switch (FIELD_EX32(c->function, DWT_FUNCTION0, FUNCTION)) {
+    case 0:
+        return;
+    case DWT_FUNCTION_WATCH_READ:
+        flags = BP_MEM_READ;
+        break;
+    case DWT_FUNCTION_WATCH_WRITE:
+        flags = BP_MEM_WRITE;
+        break;
+    case DWT_FUNCTION_WATCH_RW:
+        flags = BP_MEM_ACCESS;
+        break;
+    default:
+        qemu_log_mask(LOG_UNIMP, "DWT: comparator %d function 0x%x "
+                      "not implemented\n", n,
+                      FIELD_EX32(c->function, DWT_FUNCTION0, FUNCTION));
+        return;
+    }
+
+    if (FIELD_EX32(c->function, DWT_FUNCTION0, DATAVMATCH) ||
+        FIELD_EX32(c->function, DWT_FUNCTION0, CYCMATCH)) {
+        qemu_log_mask(LOG_UNIMP, "DWT: comparator %d data value and "
+                      "cycle count matching not implemented\n", n);
+        return;
+    }
+
+    /* MASK gives the number of low address bits to ignore */
+    len = 1ULL << c->mask;
+    cpu_watchpoint_insert(cs, c->comp & ~(len - 1), len, flags | BP_CPU,
+                          &c->wp);
+    dwt_invalidate_literal_tbs(cs, c->comp & ~(len - 1),
+                               (c->comp & ~(len - 1)) + len - 1);
+}
+
+/*
+ * Called by the CPU when one of our watchpoints fires. We only record
+ * the match; the debug event it would signal is not modelled, so the
+ * access just completes.
+ */
+static void dwt_watchpoint_hit(ARMCPU *cpu, CPUWatchpoint *wp, void *opaque)
+{
+    ARMv7MDWT *s = opaque;
+    int n;
+
+    for (n = 0; n < s->num_comparators; n++) {
+        if (s->comparator[n].wp == wp) {
+            s->comparator[n].function =
+                FIELD_DP32(s->comparator[n].function, DWT_FUNCTION0,
+                           MATCHED, 1);
+        }
+    }
+}
+
+static MemTxResult dwt_read(void *opaque, hwaddr addr,
+                            uint64_t *data, unsigned size,
+                            MemTxAttrs attrs)
+{
+    ARMv7MDWT *s = opaque;
+    ARMv7MDWTComparator *c;
+
+    if (attrs.user) {
+        return MEMTX_ERROR;
+    }
+
+    switch (addr) {
+    case A_DWT_CTRL:
+        *data = s->ctrl;
+        break;
+    case A_DWT_CYCCNT:
+        *data = dwt_get_cyccnt(s);
+        break;
+    case A_DWT_CPICNT:
+        *data = s->cpicnt;
+        break;
+    case A_DWT_EXCCNT:
+        *data = s->exccnt;
+        break;
+    case A_DWT_SLEEPCNT:
+        *data = s->sleepcnt;
+        break;
+    case A_DWT_LSUCNT:
+        *data = s->lsucnt;
+        break;
+    case A_DWT_FOLDCNT:
+        *data = s->foldcnt;
+        break;
+    case A_DWT_PCSR:
+        /* We don't sample the PC; this is the "no sample" value */
+        *data = 0xffffffff;
+        break;
+    case A_DWT_COMP0 ... A_DWT_COMP0 + 16 * ARMV7M_DWT_MAX_COMPARATORS - 1:
+        if ((addr - A_DWT_COMP0) / 16 >= s->num_comparators) {
+            *data = 0;
+            break;
+        }
+        c = &s->comparator[(addr - A_DWT_COMP0) / 16];
+        switch ((addr - A_DWT_COMP0) % 16) {
+        case A_DWT_COMP0 - A_DWT_COMP0:
+            *data = c->comp;
+            break;
+        case A_DWT_MASK0 - A_DWT_COMP0:
+            *data = c->mask;
+            break;
+        case A_DWT_FUNCTION0 - A_DWT_COMP0:
+            /* MATCHED is cleared by reading the register */
+            *data = c->function;
+            c->function = FIELD_DP32(c->function, DWT_FUNCTION0, MATCHED, 0);
+            break;
+        default:
+            *data = 0;
+            break;
+        }
+        break;
+    case 0xfd0 ... 0xffc:
+        *data = dwt_id[(addr - 0xfd0) / 4];
+        break;
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR,
+                      "DWT: Bad read offset 0x%" HWADDR_PRIx "\n", addr);
+        *data = 0;
+        break;
+    }
+    return MEMTX_OK;
+}
+
+static MemTxResult dwt_write(void *opaque, hwaddr addr,
+                             uint64_t value, unsigned size,
+                             MemTxAttrs attrs)
+{
+    ARMv7MDWT *s = opaque;
+    ARMv7MDWTComparator *c;
+    int n;
+
+    if (attrs.user) {
+        return MEMTX_ERROR;
+    }
+
+    switch (addr) {
+    case A_DWT_CTRL:
+        if ((value ^ s->ctrl) & R_DWT_CTRL_CYCCNTENA_MASK) {
+            /* Freeze the count on disable, restart it on enable */
+            dwt_set_cyccnt(s, dwt_get_cyccnt(s));
+        }
+        s->ctrl = (s->ctrl & ~DWT_CTRL_WRITABLE) | (value & DWT_CTRL_WRITABLE);
+        break;
+    case A_DWT_CYCCNT:
+        dwt_set_cyccnt(s, value);
+        break;
+    case A_DWT_CPICNT:
+        s->cpicnt = value;
+        break;
+    case A_DWT_EXCCNT:
+        s->exccnt = value;
+        break;
+    case A_DWT_SLEEPCNT:
+        s->sleepcnt = value;
+        break;
+    case A_DWT_LSUCNT:
+        s->lsucnt = value;
+        break;
+    case A_DWT_FOLDCNT:
+        s->foldcnt = value;
+        break;
+    case A_DWT_PCSR:
+        /* RO */
+        break;
+    case A_DWT_COMP0 ... A_DWT_COMP0 + 16 * ARMV7M_DWT_MAX_COMPARATORS - 1:
+        n = (addr - A_DWT_COMP0) / 16;
+        if (n >= s->num_comparators) {
+            break;
+        }
+        c = &s->comparator[n];
+        switch ((addr - A_DWT_COMP0) % 16) {
+        case A_DWT_COMP0 - A_DWT_COMP0:
+            c->comp = value;
+            break;
+        case A_DWT_MASK0 - A_DWT_COMP0:
+            c->mask = value & 0x1f;
+            break;
+        case A_DWT_FUNCTION0 - A_DWT_COMP0:
+            c->function = (c->function & ~DWT_FUNCTION_WRITABLE) |
+                          (value & DWT_FUNCTION_WRITABLE);
+            break;
+        default:
+            return MEMTX_OK;
+        }
+        dwt_update_comparator(s, n);
+        break;
+    case 0xfd0 ... 0xffc:
+        /* RO */
+        break;
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR,
+                      "DWT: Bad write offset 0x%" HWADDR_PRIx "\n", addr);
+        break;
+    }
+    return MEMTX_OK;
+}
+
+static const MemoryRegionOps dwt_ops = {
+    .read_with_attrs = dwt_read,
+    .write_with_attrs = dwt_write,
+    .endianness = DEVICE_NATIVE_ENDIAN,
+    .valid.min_access_size = 4,
+    .valid.max_access_size = 4,
+};
+
+static void dwt_reset(DeviceState *dev)
+{
+    ARMv7MDWT *s = ARMV7M_DWT(dev);
+    int n;
+
+    s->ctrl = FIELD_DP32(0, DWT_CTRL, NUMCOMP, s->num_comparators);
+    /* We generate neither trace packets nor external triggers */
+    s->ctrl = FIELD_DP32(s->ctrl, DWT_CTRL, NOTRCPKT, 1);
+    s->ctrl = FIELD_DP32(s->ctrl, DWT_CTRL, NOEXTTRIG, 1);
+    dwt_set_cyccnt(s, 0);
+    s->cpicnt = 0;
+    s->exccnt = 0;
+    s->sleepcnt = 0;
+    s->lsucnt = 0;
+    s->foldcnt = 0;
+
+    for (n = 0; n < s->num_comparators; n++) {
+        s->comparator[n].comp = 0;
+        s->comparator[n].mask = 0;
+        s->comparator[n].function = 0;
+        dwt_update_comparator(s, n);
+    }
+}
+
+static void dwt_instance_init(Object *obj)
+{
+    SysBusDevice *sbd = SYS_BUS_DEVICE(obj);
+    ARMv7MDWT *s = ARMV7M_DWT(obj);
+
+    memory_region_init_io(&s->iomem, obj, &dwt_ops, s, "armv7m-dwt", 0x1000);
+    sysbus_init_mmio(sbd, &s->iomem);
+
+    s->cpuclk = qdev_init_clock_in(DEVICE(obj), "cpuclk",
+                                   dwt_cpuclk_update, s, ClockPreUpdate);
+}
+
+static void dwt_realize(DeviceState *dev, Error **errp)
+{
+    ARMv7MDWT *s = ARMV7M_DWT(dev);
+
+    if (!s->cpu) {
+        error_setg(errp, "armv7m-dwt: cpu must be set");
+        return;
+    }
+    if (!clock_has_source(s->cpuclk)) {
+        error_setg(errp, "armv7m-dwt: cpuclk must be connected");
+        return;
+    }
+    if (s->num_comparators > ARMV7M_DWT_MAX_COMPARATORS) {
+        error_setg(errp, "armv7m-dwt: num-comparators must be at most %d",
+                   ARMV7M_DWT_MAX_COMPARATORS);
+        return;
+    }
+
+    arm_register_m_watchpoint_hook(s->cpu, dwt_watchpoint_hit, s);
+}
+
+static int dwt_post_load(void *opaque, int version_id)
+{
+    ARMv7MDWT *s = opaque;
+    int n;
+
+    /* The CPU watchpoints themselves are not migrated */
+    for (n = 0; n < s->num_comparators; n++) {
+        s->comparator[n].wp = NULL;
+        dwt_update_comparator(s, n);
+    }
+    return 0;
+}
+
+static const VMStateDescription vmstate_dwt_comparator = {
+    .name = "armv7m_dwt/comparator",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(comp, ARMv7MDWTComparator),
+        VMSTATE_UINT32(mask, ARMv7MDWTComparator),
+        VMSTATE_UINT32(function, ARMv7MDWTComparator),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static const VMStateDescription vmstate_dwt = {
+    .name = "armv7m_dwt",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .post_load = dwt_post_load,
+    .fields = (const VMStateField[]) {
+        VMSTATE_CLOCK(cpuclk, ARMv7MDWT),
+        VMSTATE_UINT32(ctrl, ARMv7MDWT),
+        VMSTATE_UINT32(cyccnt, ARMv7MDWT),
+        VMSTATE_INT64(cyccnt_start, ARMv7MDWT),
+        VMSTATE_UINT8(cpicnt, ARMv7MDWT),
+        VMSTATE_UINT8(exccnt, ARMv7MDWT),
+        VMSTATE_UINT8(sleepcnt, ARMv7MDWT),
+        VMSTATE_UINT8(lsucnt, ARMv7MDWT),
+        VMSTATE_UINT8(foldcnt, ARMv7MDWT),
+        VMSTATE_STRUCT_ARRAY(comparator, ARMv7MDWT,
+                             ARMV7M_DWT_MAX_COMPARATORS, 1,
+                             vmstate_dwt_comparator, ARMv7MDWTComparator),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static Property dwt_properties[] = {
+    DEFINE_PROP_UINT32("num-comparators", ARMv7MDWT, num_comparators,
+                       ARMV7M_DWT_MAX_COMPARATORS),
+    DEFINE_PROP_END_OF_LIST(),
+};
+
+static void dwt_class_init(ObjectClass *klass, void *data)
+{
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    dc->vmsd = &vmstate_dwt;
+    device_class_set_legacy_reset(dc, dwt_reset);
+    dc->realize = dwt_realize;
+    device_class_set_props(dc, dwt_properties);
+}
+
+static const TypeInfo armv7m_dwt_info = {
+    .name = TYPE_ARMV7M_DWT,
+    .parent = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(ARMv7MDWT),
+    .instance_init = dwt_instance_init,
+    .class_init = dwt_class_init,
+};
+
+static void armv7m_dwt_register_types(void)
+{
+    type_register_static(&armv7m_dwt_info);
+}
+
+type_init(armv7m_dwt_register_types);
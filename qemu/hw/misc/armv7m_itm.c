@@ -0,0 +1,270 @@
+/*
+ * ARMv7-M Instrumentation Trace Macrocell (ITM)
+ *
+ * This code is licensed under the GPL version 2 or later.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "qemu/osdep.h"
+#include "hw/misc/armv7m_itm.h"
+#include "hw/qdev-properties.h"
+#include "hw/qdev-properties-system.h"
+#include "hw/registerfields.h"
+#include "migration/vmstate.h"
+#include "qemu/log.h"
+#include "qemu/main-loop.h"
+#include "qemu/module.h"
+
+/* Stimulus port n is at ITM_STIM0 + 4 * n */
+REG32(ITM_STIM0, 0x0)
+    FIELD(ITM_STIM0, FIFOREADY, 0, 1)
+REG32(ITM_TER, 0xe00)
+REG32(ITM_TPR, 0xe40)
+REG32(ITM_TCR, 0xe80)
+    FIELD(ITM_TCR, ITMENA, 0, 1)
+    FIELD(ITM_TCR, BUSY, 23, 1)
+REG32(ITM_LAR, 0xfb0)
+REG32(ITM_LSR, 0xfb4)
+
+/* Each ITM_TPR bit covers eight stimulus ports */
+#define ITM_TPR_WRITABLE MAKE_64BIT_MASK(0, ARMV7M_ITM_NUM_PORTS / 8)
+/* ITMENA, TSENA, SYNCENA, TXENA, SWOENA, TSPrescale, GTSFREQ, TraceBusID */
+#define ITM_TCR_WRITABLE 0x007f0f1f
+
+/* Peripheral and component ID registers, from 0xfd0 */
+static const uint8_t itm_id[] = {
+    0x04, 0x00, 0x00, 0x00, /* PID4..PID7 */
+    0x01, 0xb0, 0x3b, 0x00, /* PID0..PID3 */
+    0x0d, 0xe0, 0x05, 0xb1, /* CID0..CID3 */
+};
+
+static void itm_flush(ARMv7MITM *s)
+{
+    if (s->buf_len) {
+        qemu_chr_fe_write_all(&s->chr, s->buf, s->buf_len);
+        s->buf_len = 0;
+    }
+}
+
+static void itm_flush_bh(void *opaque)
+{
+    itm_flush(opaque);
+}
+
+/*
+ * Append the instrumentation packet for a @size byte write of @value
+ * to stimulus port @port.
+ */
+static void itm_emit(ARMv7MITM *s, int port, uint32_t value, unsigned size)
+{
+    /* The low two header bits encode the payload size: 1, 2 or 4 bytes */
+    uint8_t ss = size == 4 ? 3 : size;
+    int i;
+
+    if (s->buf_len + 1 + size > sizeof(s->buf)) {
+        itm_flush(s);
+    }
+    if (s->buf_len == 0) {
+        qemu_bh_schedule(s->flush_bh);
+    }
+
+    s->buf[s->buf_len++] = port << 3 | ss;
+    for (i = 0; i < size; i++) {
+        s->buf[s->buf_len++] = value >> (i * 8);
+    }
+}
+
+static MemTxResult itm_read(void *opaque, hwaddr addr,
+                            uint64_t *data, unsigned size,
+                            MemTxAttrs attrs)
+{
+    ARMv7MITM *s = opaque;
+
+    if (addr < 4 * ARMV7M_ITM_NUM_PORTS) {
+        /* Packets never back up, so every port can always take a write */
+        *data = R_ITM_STIM0_FIFOREADY_MASK;
+        return MEMTX_OK;
+    }
+
+    if (attrs.user) {
+        return MEMTX_ERROR;
+    }
+
+    switch (addr) {
+    case A_ITM_TER:
+        *data = s->ter;
+        break;
+    case A_ITM_TPR:
+        *data = s->tpr;
+        break;
+    case A_ITM_TCR:
+        *data = s->tcr;
+        break;
+    case A_ITM_LSR:
+        /* The software lock is not implemented for processor accesses */
+        *data = 0;
+        break;
+    case 0xfd0 ... 0xffc:
+        *data = itm_id[(addr - 0xfd0) / 4];
+        break;
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR,
+                      "ITM: Bad read offset 0x%" HWADDR_PRIx "\n", addr);
+        *data = 0;
+        break;
+    }
+    return MEMTX_OK;
+}
+
+static MemTxResult itm_write(void *opaque, hwaddr addr,
+                             uint64_t value, unsigned size,
+                             MemTxAttrs attrs)
+{
+    ARMv7MITM *s = opaque;
+    int port;
+
+    if (addr < 4 * ARMV7M_ITM_NUM_PORTS) {
+        port = addr / 4;
+        if (!FIELD_EX32(s->tcr, ITM_TCR, ITMENA) ||
+            !extract32(s->ter, port, 1) ||
+            !qemu_chr_fe_backend_connected(&s->chr)) {
+            return MEMTX_OK;
+        }
+        if (attrs.user && extract32(s->tpr, port / 8, 1)) {
+            /* Unprivileged writes to privileged ports are ignored */
+            return MEMTX_OK;
+        }
+        itm_emit(s, port, value, size);
+        return MEMTX_OK;
+    }
+
+    if (attrs.user) {
+        return MEMTX_ERROR;
+    }
+
+    if (size != 4) {
+        qemu_log_mask(LOG_GUEST_ERROR,
+                      "ITM: Bad write of size %u to offset 0x%" HWADDR_PRIx
+                      "\n", size, addr);
+        return MEMTX_OK;
+    }
+
+    switch (addr) {
+    case A_ITM_TER:
+        s->ter = value;
+        break;
+    case A_ITM_TPR:
+        s->tpr = value & ITM_TPR_WRITABLE;
+        break;
+    case A_ITM_TCR:
+        s->tcr = value & ITM_TCR_WRITABLE;
+        break;
+    case A_ITM_LAR:
+    case A_ITM_LSR:
+    case 0xfd0 ... 0xffc:
+        /* Lock not implemented; ID registers RO */
+        break;
+    default:
+        qemu_log_mask(LOG_GUEST_ERROR,
+                      "ITM: Bad write offset 0x%" HWADDR_PRIx "\n", addr);
+        break;
+    }
+    return MEMTX_OK;
+}
+
+static const MemoryRegionOps itm_ops = {
+    .read_with_attrs = itm_read,
+    .write_with_attrs = itm_write,
+    .endianness = DEVICE_NATIVE_ENDIAN,
+    /* Byte and halfword stimulus port writes produce shorter packets */
+    .valid.min_access_size = 1,
+    .valid.max_access_size = 4,
+};
+
+static void itm_reset(DeviceState *dev)
+{
+    ARMv7MITM *s = ARMV7M_ITM(dev);
+
+    /* Don't lose trace written just before the reset */
+    itm_flush(s);
+    s->ter = 0;
+    s->tpr = 0;
+    s->tcr = 0;
+}
+
+static void itm_instance_init(Object *obj)
+{
+    SysBusDevice *sbd = SYS_BUS_DEVICE(obj);
+    ARMv7MITM *s = ARMV7M_ITM(obj);
+
+    memory_region_init_io(&s->iomem, obj, &itm_ops, s, "armv7m-itm", 0x1000);
+    sysbus_init_mmio(sbd, &s->iomem);
+}
+
+static void itm_realize(DeviceState *dev, Error **errp)
+{
+    ARMv7MITM *s = ARMV7M_ITM(dev);
+
+    s->flush_bh = qemu_bh_new_guarded(itm_flush_bh, s,
+                                      &dev->mem_reentrancy_guard);
+}
+
+static void itm_unrealize(DeviceState *dev)
+{
+    ARMv7MITM *s = ARMV7M_ITM(dev);
+
+    itm_flush(s);
+    qemu_bh_delete(s->flush_bh);
+}
+
+static int itm_pre_save(void *opaque)
+{
+    /* Buffered packets are not migrated, so get them out now */
+    itm_flush(opaque);
+    return 0;
+}
+
+static const VMStateDescription vmstate_itm = {
+    .name = "armv7m_itm",
+    .version_id = 1,
+    .minimum_version_id = 1,
+    .pre_save = itm_pre_save,
+    .fields = (const VMStateField[]) {
+        VMSTATE_UINT32(ter, ARMv7MITM),
+        VMSTATE_UINT32(tpr, ARMv7MITM),
+        VMSTATE_UINT32(tcr, ARMv7MITM),
+        VMSTATE_END_OF_LIST()
+    }
+};
+
+static Property itm_properties[] = {
+    DEFINE_PROP_CHR("chardev", ARMv7MITM, chr),
+    DEFINE_PROP_END_OF_LIST(),
+};
+
+static void itm_class_init(ObjectClass *klass, void *data)
+{
+    DeviceClass *dc = DEVICE_CLASS(klass);
+
+    dc->vmsd = &vmstate_itm;
+    device_class_set_legacy_reset(dc, itm_reset);
+    dc->realize = itm_realize;
+    dc->unrealize = itm_unrealize;
+    device_class_set_props(dc, itm_properties);
+}
+
+static const TypeInfo armv7m_itm_info = {
+    .name = TYPE_ARMV7M_ITM,
+    .parent = TYPE_SYS_BUS_DEVICE,
+    .instance_size = sizeof(ARMv7MITM),
+    .instance_init = itm_instance_init,
+    .class_init = itm_class_init,
+};
+
+static void armv7m_itm_register_types(void)
+{
+    type_register_static(&armv7m_itm_info);
+}
+
+type_init(armv7m_itm_register_types);
@@ -34,6 +34,8 @@ static void s32k358_pit_tick(void *opaque) {
         qemu_irq_pulse(s->irq); /* Trigger interrupt */
         //qemu_set_irq(s->irq, 0);
     }
+    /* Wake a CPU polling for the expiry */
+    poll_wait_changed(&s->poll);
 }
 
 /* Clock Update Callback */
@@ -48,28 +50,46 @@ static void s32k358_pit_clk_update(void *opaque, ClockEvent event) {
 /* Register Read */
 static uint64_t s32k358_pit_read(void *opaque, hwaddr offset, unsigned size) {
     S32K358PITState *s = S32K358_PIT(opaque);
+    uint64_t value;
 
     switch (offset) {
     case PIT_MCR:
-        return s->mcr;
+        value = s->mcr;
+        break;
     case PIT_LDVAL0:
-        return s->ldval;
+        value = s->ldval;
+        break;
     case PIT_CVAL0:
-        return ptimer_get_count(s->timer);
+        value = ptimer_get_count(s->timer);
+        break;
     case PIT_TCTRL0:
-        return s->tctrl;
+        value = s->tctrl;
+        break;
     case PIT_TFLG0:
-        return s->tflg;
+        value = s->tflg;
+        break;
     default:
         qemu_log_mask(LOG_GUEST_ERROR, "Invalid read offset 0x%" HWADDR_PRIx "\n", offset);
-        return 0;
+        value = 0;
+        break;
+    }
+
+    /*
+     * CVAL0 can read the same many times between two decrements, but only
+     * an expiry wakes the poller, so leave polls of the counter alone.
+     */
+    if (offset != PIT_CVAL0) {
+        poll_wait_read(&s->poll, offset, value);
     }
+    return value;
 }
 
 /* Register Write */
 static void s32k358_pit_write(void *opaque, hwaddr offset, uint64_t value, unsigned size) {
     S32K358PITState *s = S32K358_PIT(opaque);
 
+    poll_wait_changed(&s->poll);
+
     switch (offset) {
     case PIT_MCR:
         s->mcr = value & 0xFFFFFFFD; /* Only handle MDIS and FRZ bits */
@@ -166,6 +186,8 @@ static void s32k358_pit_realize(DeviceState *dev, Error **errp) {
     ptimer_transaction_begin(s->timer);
     ptimer_set_period_from_clock(s->timer, s->pclk, 1);
     ptimer_transaction_commit(s->timer);
+
+    poll_wait_init(&s->poll);
     
     qemu_log("PIT realized successfully\n");
 }
@@ -799,6 +799,9 @@ struct MemoryRegion {
 
     /* For devices designed to perform re-entrant IO into their own IO MRs */
     bool disable_reentrancy_guard;
+
+    /* Extra CPU cycles per access, for targets that model them */
+    uint8_t wait_states;
 };
 
 struct IOMMUMemoryRegion {
@@ -1950,6 +1953,19 @@ static inline bool memory_region_is_nonvolatile(MemoryRegion *mr)
     return mr->nonvolatile;
 }
 
+/**
+ * memory_region_get_wait_states: get the access wait states of a region
+ *
+ * Returns the number of extra CPU cycles an access to the region takes,
+ * as set by memory_region_set_wait_states().
+ *
+ * @mr: the memory region being queried
+ */
+static inline unsigned memory_region_get_wait_states(MemoryRegion *mr)
+{
+    return mr->wait_states;
+}
+
 /**
  * memory_region_get_fd: Get a file descriptor backing a RAM memory region.
  *
@@ -2168,6 +2184,19 @@ void memory_region_set_readonly(MemoryRegion *mr, bool readonly);
  */
 void memory_region_set_nonvolatile(MemoryRegion *mr, bool nonvolatile);
 
+/**
+ * memory_region_set_wait_states: set the access wait states of a region
+ *
+ * Records how many extra CPU cycles an access to the region takes, e.g.
+ * for flash behind a slow bus.  This is only used by targets that charge
+ * cycle costs to icount (Arm M-profile with "icount-cycles"), and only
+ * when code is translated: set it before the guest starts running.
+ *
+ * @mr: the region being updated.
+ * @wait_states: the number of wait states.
+ */
+void memory_region_set_wait_states(MemoryRegion *mr, uint8_t wait_states);
+
 /**
  * memory_region_rom_device_set_romd: enable/disable ROMD mode
  *
@@ -78,6 +78,7 @@ struct TranslationBlock {
 #define CF_NOIRQ         0x00010000 /* Generate an uninterruptible TB */
 #define CF_PCREL         0x00020000 /* Opcodes in TB are PC-relative */
 #define CF_BP_PAGE       0x00040000 /* Breakpoint present in code page */
+#define CF_ICOUNT_CAP    0x00080000 /* CF_COUNT_MASK bounds the icount cost */
 #define CF_CLUSTER_MASK  0xff000000 /* Top 8 bits are cluster ID */
 #define CF_CLUSTER_SHIFT 24
 
@@ -88,6 +89,11 @@ struct TranslationBlock {
     /* size of target code for this block (1 <= size <= TARGET_PAGE_SIZE) */
     uint16_t size;
     uint16_t icount;
+    /*
+     * With CF_USE_ICOUNT, the instruction budget this TB charges.  This
+     * is icount unless the target weights instructions by their cost.
+     */
+    uint16_t icount_cost;
 
     struct tb_tc tc;
 
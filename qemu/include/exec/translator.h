@@ -71,6 +71,11 @@ typedef enum DisasJumpType {
  * @is_jmp: What instruction to disassemble next.
  * @num_insns: Number of translated instructions (including current).
  * @max_insns: Maximum number of instructions to be translated in this TB.
+ * @insn_cost: icount cost of the current instruction.  Set to 1 before
+ *             translate_insn; targets that model instruction timing may
+ *             change it, including to 0 for an insn issued in parallel
+ *             with the previous one.
+ * @icount_cost: icount cost of the instructions translated so far.
  * @plugin_enabled: TCG plugin enabled in this TB.
  * @fake_insn: True if translator_fake_ldb used.
  * @insn_start: The last op emitted by the insn_start hook,
@@ -85,6 +90,8 @@ struct DisasContextBase {
     DisasJumpType is_jmp;
     int num_insns;
     int max_insns;
+    int insn_cost;
+    int icount_cost;
     bool plugin_enabled;
     bool fake_insn;
     struct TCGOp *insn_start;
@@ -13,6 +13,8 @@
 #include "hw/sysbus.h"
 #include "hw/intc/armv7m_nvic.h"
 #include "hw/misc/armv7m_ras.h"
+#include "hw/misc/armv7m_dwt.h"
+#include "hw/misc/armv7m_itm.h"
 #include "target/arm/idau.h"
 #include "qom/object.h"
 #include "hw/clock.h"
@@ -29,6 +31,19 @@ struct BitBandState {
     MemoryRegion iomem;
     uint32_t base;
     MemoryRegion *source_memory;
+
+    /*
+     * Cached section of the bit-band source window, so that alias
+     * accesses to RAM can go straight to host memory. cache_host is NULL
+     * for MMIO sections. Invalidated by source_listener whenever the
+     * memory topology changes.
+     */
+    MemoryListener source_listener;
+    MemoryRegion *cache_mr;
+    hwaddr cache_start;
+    hwaddr cache_size;
+    hwaddr cache_offset;
+    uint8_t *cache_host;
 };
 
 #define TYPE_ARMV7M "armv7m"
@@ -61,6 +76,9 @@ OBJECT_DECLARE_SIMPLE_TYPE(ARMv7MState, ARMV7M)
  *   value as mpu-ns-regions if the CPU implements the Security Extension)
  * + Clock input "refclk" is the external reference clock for the systick timers
  * + Clock input "cpuclk" is the main CPU clock
+ *
+ * For CPUs with the Main Extension the container also creates an ITM;
+ * its trace output is connected with -global armv7m-itm.chardev=<id>.
  */
 struct ARMv7MState {
     /*< private >*/
@@ -70,6 +88,8 @@ struct ARMv7MState {
     BitBandState bitband[ARMV7M_NUM_BITBANDS];
     ARMCPU *cpu;
     ARMv7MRAS ras;
+    ARMv7MDWT dwt;
+    ARMv7MITM itm;
     SysTickState systick[M_REG_NUM_BANKS];
 
     /* MemoryRegion we pass to the CPU, with our devices layered on
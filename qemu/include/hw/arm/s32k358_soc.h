@@ -58,6 +58,7 @@ struct S32K358State {
     MemoryRegion flash;               /* Flash memory */
     MemoryRegion flash_alias;         /* Alias for flash for convenient MMIO */
     MemoryRegion sram;                /* SRAM memory */
+    uint8_t flash_wait_states;        /* Flash wait states (icount-cycles) */
 
     /* System clock */
     Clock *sysclk;
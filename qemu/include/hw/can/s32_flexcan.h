@@ -3,6 +3,7 @@
 
 #include "hw/sysbus.h"      // SysBusDevice base class
 #include "hw/can/can_bus.h"  // Logical CAN bus simulation
+#include "hw/core/poll-wait.h" // Halting CPUs that spin on a register
 #include "qapi/error.h"      // QEMU error reporting
 
 /* -------------------- Type Declaration -------------------- */
@@ -21,6 +22,8 @@ typedef struct FlexCANState {
     uint32_t CTRL;           /* Control Register */
     uint32_t TFR;            /* Transmit Frame Register */
     uint32_t RFR;            /* Receive Frame Register */
+
+    PollWait poll;           /* Detects firmware spinning on a register */
 } FlexCANState;
 
 /* -------------------- Bus Communication -------------------- */
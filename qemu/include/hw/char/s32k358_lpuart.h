@@ -3,6 +3,7 @@
 
 #include "hw/sysbus.h"       // QEMU SysBusDevice
 #include "chardev/char-fe.h" // Character device frontend
+#include "hw/core/poll-wait.h" // Halting CPUs that spin on STAT
 #include "qom/object.h"      // QEMU Object Model
 
 /* -------------------- LPUART Register Offsets -------------------- */
@@ -16,6 +17,8 @@
 #define LPUART_STAT_RDRF    (1 << 21) /* Receive Data Register Full */
 
 /* -------------------- Control Register Bits -------------------- */
+#define LPUART_CTRL_TIE     (1 << 23) /* Transmit Interrupt Enable */
+#define LPUART_CTRL_RIE     (1 << 21) /* Receiver Interrupt Enable */
 #define LPUART_CTRL_TE      (1 << 19) /* Transmitter Enable */
 #define LPUART_CTRL_RE      (1 << 18) /* Receiver Enable */
 
@@ -36,6 +39,7 @@ struct S32K358LPUARTState {
     uint32_t data;            /* DATA register: transmit/receive data byte */
 
     CharBackend chr;          /* Character backend for UART communication */
+    PollWait poll;            /* Detects firmware spinning on a register */
 };
 
 #endif /* HW_S32K358_LPUART_H */
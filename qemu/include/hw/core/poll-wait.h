@@ -0,0 +1,81 @@
+/*
+ * Parking a CPU that busy-polls a device register
+ *
+ * This code is licensed under the GPL version 2 or later.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/*
+ * Firmware often waits for a device by spinning on a status register
+ * ("while (!(STAT & RDRF)) ;"). Under TCG each iteration is a TB
+ * execution plus an MMIO dispatch, and the loop keeps a host CPU busy
+ * for as long as the wait lasts.
+ *
+ * A device that embeds a PollWait reports each guest register read with
+ * poll_wait_read(). After POLL_WAIT_READS consecutive reads of the same
+ * register returning the same value, the reading CPU is halted, just as
+ * if it had executed WFI. The device must call poll_wait_changed()
+ * whenever something other than the reading CPU may change what its
+ * registers read as: a guest write, received data, a timer expiring.
+ * That wakes the CPU, which then re-reads the register and leaves the
+ * loop. As a safety net for state changes a device does not report, the
+ * CPU is also woken after POLL_WAIT_TIMEOUT_NS of virtual time.
+ *
+ * While the CPU is halted, virtual time advances as it does for WFI: with
+ * icount it jumps to the next timer deadline, without it it follows the
+ * host clock but the host CPU is idle.
+ *
+ * The detector is off unless enabled with -accel tcg,poll-wait=on. The
+ * CPU is woken whenever the VM stops, so that it is never migrated or
+ * snapshotted in a halted state that only the PollWait knows about.
+ */
+
+#ifndef HW_CORE_POLL_WAIT_H
+#define HW_CORE_POLL_WAIT_H
+
+#include "exec/hwaddr.h"
+#include "qemu/timer.h"
+
+/* Set from the TCG accelerator's poll-wait property */
+extern bool poll_wait_enabled;
+
+/* Identical consecutive register reads that count as a polling loop */
+#define POLL_WAIT_READS 32
+/* Longest a CPU stays halted without poll_wait_changed() */
+#define POLL_WAIT_TIMEOUT_NS (1 * SCALE_MS)
+
+typedef struct PollWait {
+    QEMUTimer *timer;
+    /* The CPU we halted, or NULL */
+    CPUState *waiter;
+    /* Last register read, the value it returned and how many times */
+    hwaddr addr;
+    uint64_t value;
+    unsigned int count;
+} PollWait;
+
+/**
+ * poll_wait_init: initialize a PollWait embedded in a device
+ */
+void poll_wait_init(PollWait *pw);
+
+/**
+ * poll_wait_read: report a guest read of a device register
+ * @addr: the register offset
+ * @value: the value the read returned
+ *
+ * Must be called from the device's MMIO read handler, so that
+ * current_cpu is the CPU doing the read.
+ */
+void poll_wait_read(PollWait *pw, hwaddr addr, uint64_t value);
+
+/**
+ * poll_wait_changed: the device's registers may read differently now
+ *
+ * Wakes the CPU halted by poll_wait_read(), if any, and restarts the
+ * count of identical reads.
+ */
+void poll_wait_changed(PollWait *pw);
+
+#endif
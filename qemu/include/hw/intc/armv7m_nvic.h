@@ -14,6 +14,7 @@
 #include "hw/sysbus.h"
 #include "hw/timer/armv7m_systick.h"
 #include "qom/object.h"
+#include "qemu/bitops.h"
 
 #define TYPE_NVIC "armv7m_nvic"
 OBJECT_DECLARE_SIMPLE_TYPE(NVICState, NVIC)
@@ -22,6 +23,8 @@ OBJECT_DECLARE_SIMPLE_TYPE(NVICState, NVIC)
 #define NVIC_MAX_VECTORS 512
 /* Number of internal exceptions */
 #define NVIC_INTERNAL_VECTORS 16
+/* Highest permitted number of external interrupts */
+#define NVIC_MAX_EXT_IRQS (NVIC_MAX_VECTORS - NVIC_INTERNAL_VECTORS)
 
 typedef struct VecInfo {
     /* Exception priorities can range from -3 to 255; only the unmodifiable
@@ -34,6 +37,31 @@ typedef struct VecInfo {
     uint8_t level; /* exceptions <=15 never set level */
 } VecInfo;
 
+/* Bucket n of a latency histogram counts values in [2^(n-1), 2^n) */
+#define NVIC_LATENCY_BUCKETS 32
+
+typedef struct NVICLatencyHist {
+    uint32_t count[NVIC_LATENCY_BUCKETS];
+} NVICLatencyHist;
+
+typedef struct NVICIRQLatency {
+    /*
+     * When the exception was last pended and when its handler was last
+     * entered, in QEMU_CLOCK_VIRTUAL ns and (with icount) instructions;
+     * pend_ns and active_ns are -1 if there is no measurement in progress.
+     */
+    int64_t pend_ns;
+    int64_t pend_insns;
+    int64_t active_ns;
+    int64_t active_insns;
+    /* Pend to handler entry */
+    NVICLatencyHist entry_ns;
+    NVICLatencyHist entry_insns;
+    /* Handler entry to exception return, including any preemption */
+    NVICLatencyHist handler_ns;
+    NVICLatencyHist handler_insns;
+} NVICIRQLatency;
+
 struct NVICState {
     /*< private >*/
     SysBusDevice parent_obj;
@@ -76,6 +104,24 @@ struct NVICState {
     int exception_prio; /* group prio of the highest prio active exception */
     int vectpending_prio; /* group prio of the exception in vectpending */
 
+    /* Bitmaps mirroring the enabled, pending and active flags of the
+     * external interrupts in vectors[] (bit n is exception
+     * NVIC_INTERNAL_VECTORS + n). They are cached state like the fields
+     * above, kept in sync whenever one of those flags changes, and let
+     * the non-secure recompute visit only the interrupts that are
+     * actually pending or active instead of all num_irq vectors.
+     */
+    unsigned long ext_enabled[BITS_TO_LONGS(NVIC_MAX_EXT_IRQS)];
+    unsigned long ext_pending[BITS_TO_LONGS(NVIC_MAX_EXT_IRQS)];
+    unsigned long ext_active[BITS_TO_LONGS(NVIC_MAX_EXT_IRQS)];
+
+    /*
+     * Latency statistics, one entry per exception number. These are
+     * not migrated; banked exceptions share a single entry.
+     */
+    NVICIRQLatency *latency;
+    uint64_t *irq_counts;
+
     MemoryRegion sysregmem;
 
     uint32_t num_irq;
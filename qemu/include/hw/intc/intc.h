@@ -23,6 +23,8 @@ struct InterruptStatsProviderClass {
     bool (*get_statistics)(InterruptStatsProvider *obj, uint64_t **irq_counts,
                            unsigned int *nb_irqs);
     void (*print_info)(InterruptStatsProvider *obj, GString *buf);
+    /* Optional: print interrupt latency statistics */
+    void (*print_irq_latency)(InterruptStatsProvider *obj, GString *buf);
 };
 
 #endif
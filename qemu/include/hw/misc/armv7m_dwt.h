@@ -0,0 +1,77 @@
+/*
+ * ARMv7-M Data Watchpoint and Trace (DWT) unit
+ *
+ * This code is licensed under the GPL version 2 or later.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/*
+ * This is a model of the DWT register block of an ARMv7-M CPU
+ * (the registers starting at 0xE0001000 with DWT_CTRL).
+ *
+ * QEMU interface:
+ *  + sysbus MMIO region 0: the register bank
+ *  + Clock input "cpuclk": the processor clock, which CYCCNT counts
+ *    when icount is not in use
+ *  + Property "num-comparators": number of comparators (at most
+ *    ARMV7M_DWT_MAX_COMPARATORS)
+ *
+ * The board code must set the "cpu" field to the CPU the DWT belongs to
+ * before realizing the device.
+ *
+ * CYCCNT is computed when it is read, from the instruction count when
+ * icount is enabled and from QEMU_CLOCK_VIRTUAL and the CPU clock
+ * frequency otherwise, so counting costs nothing while the guest runs.
+ * QEMU has no pipeline model, so the CPI, exception overhead, sleep,
+ * LSU and folded-instruction counters only change when written.
+ * Data address comparators are implemented with CPU watchpoints and
+ * record matches in DWT_FUNCTIONn.MATCHED; they do not generate debug
+ * events. Trace packets are not generated.
+ */
+
+#ifndef HW_MISC_ARMV7M_DWT_H
+#define HW_MISC_ARMV7M_DWT_H
+
+#include "target/arm/cpu-qom.h"
+#include "hw/core/cpu.h"
+#include "hw/sysbus.h"
+#include "qom/object.h"
+
+#define TYPE_ARMV7M_DWT "armv7m-dwt"
+OBJECT_DECLARE_SIMPLE_TYPE(ARMv7MDWT, ARMV7M_DWT)
+
+#define ARMV7M_DWT_MAX_COMPARATORS 4
+
+typedef struct ARMv7MDWTComparator {
+    uint32_t comp;
+    uint32_t mask;
+    uint32_t function;
+    CPUWatchpoint *wp;
+} ARMv7MDWTComparator;
+
+struct ARMv7MDWT {
+    /*< private >*/
+    SysBusDevice parent_obj;
+
+    /*< public >*/
+    MemoryRegion iomem;
+    Clock *cpuclk;
+    ARMCPU *cpu;
+
+    uint32_t ctrl;
+    /* CYCCNT value when counting last (re)started, and the time of that */
+    uint32_t cyccnt;
+    int64_t cyccnt_start;
+    uint8_t cpicnt;
+    uint8_t exccnt;
+    uint8_t sleepcnt;
+    uint8_t lsucnt;
+    uint8_t foldcnt;
+    ARMv7MDWTComparator comparator[ARMV7M_DWT_MAX_COMPARATORS];
+
+    /* Properties */
+    uint32_t num_comparators;
+};
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ * ARMv7-M Instrumentation Trace Macrocell (ITM)
+ *
+ * This code is licensed under the GPL version 2 or later.
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/*
+ * This is a model of the ITM register block of an M-profile CPU
+ * (the registers starting at 0xE0000000 with the stimulus ports).
+ *
+ * QEMU interface:
+ *  + sysbus MMIO region 0: the register bank
+ *  + Property "chardev": the character device that receives the trace
+ *    stream. For an ITM created by the armv7m container this is set with
+ *    e.g. "-chardev file,id=itm,path=itm.bin -global armv7m-itm.chardev=itm"
+ *
+ * Writes to enabled stimulus ports are encoded as ITM instrumentation
+ * packets (a header byte giving the port number and payload size, then
+ * the payload in little-endian order), which is the byte stream standard
+ * SWO decoders expect. The packets are collected in a buffer that is
+ * flushed to the chardev from a bottom half, so a stimulus port write
+ * costs the guest a single store: the ports always read as ready and
+ * never stall. Timestamp, synchronization and hardware source packets
+ * are not generated.
+ */
+
+#ifndef HW_MISC_ARMV7M_ITM_H
+#define HW_MISC_ARMV7M_ITM_H
+
+#include "chardev/char-fe.h"
+#include "hw/sysbus.h"
+#include "qom/object.h"
+
+#define TYPE_ARMV7M_ITM "armv7m-itm"
+OBJECT_DECLARE_SIMPLE_TYPE(ARMv7MITM, ARMV7M_ITM)
+
+#define ARMV7M_ITM_NUM_PORTS 32
+/* Enough for 64 word-sized packets between flushes */
+#define ARMV7M_ITM_BUF_SIZE 320
+
+struct ARMv7MITM {
+    /*< private >*/
+    SysBusDevice parent_obj;
+
+    /*< public >*/
+    MemoryRegion iomem;
+    CharBackend chr;
+    QEMUBH *flush_bh;
+
+    uint32_t ter;
+    uint32_t tpr;
+    uint32_t tcr;
+
+    /* Encoded packets not yet written to the chardev */
+    uint8_t buf[ARMV7M_ITM_BUF_SIZE];
+    uint32_t buf_len;
+};
+
+#endif
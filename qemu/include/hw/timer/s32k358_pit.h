@@ -3,6 +3,7 @@
 
 #include "hw/sysbus.h"
 #include "hw/ptimer.h"
+#include "hw/core/poll-wait.h"
 #include "hw/qdev-clock.h"
 #include "qom/object.h"
 #include "hw/clock.h"
@@ -39,6 +40,9 @@ struct S32K358PITState {
     uint32_t ldval;   /* Load Value Register */
     uint32_t tctrl;   /* Timer Control Register */
     uint32_t tflg;    /* Timer Flag Register */
+
+    /* Detects firmware spinning on TFLG0 */
+    PollWait poll;
 };
 
 #endif /* HW_S32K358_PIT_H */
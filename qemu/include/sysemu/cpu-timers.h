@@ -96,6 +96,17 @@ int64_t cpu_get_clock(void);
 
 void qemu_timer_notify_cb(void *opaque, QEMUClockType type);
 
+/*
+ * Idle warp: without icount, jump QEMU_CLOCK_VIRTUAL straight to the
+ * next deadline whenever all vCPUs are idle, rather than waiting for it
+ * in real time (like "-icount sleep=off", but for the host-clock based
+ * virtual clock). Enabled with "-accel tcg,idle-warp=on".
+ */
+extern bool idle_warp_enabled;
+
+/* Caller must hold BQL */
+void cpu_idle_warp(void);
+
 /* get/set VIRTUAL clock and VM elapsed ticks via the cpus accel interface */
 int64_t cpus_get_virtual_clock(void);
 void cpus_set_virtual_clock(int64_t new_time);
@@ -185,6 +185,8 @@ DEF("accel", HAS_ARG, QEMU_OPTION_accel,
     "                kernel-irqchip=on|off|split controls accelerated irqchip support (default=on)\n"
     "                kvm-shadow-mem=size of KVM shadow MMU in bytes\n"
     "                one-insn-per-tb=on|off (one guest instruction per TCG translation block)\n"
+    "                idle-warp=on|off (skip virtual time ahead when all vCPUs are idle)\n"
+    "                poll-wait=on|off (halt vCPUs busy-polling a device register)\n"
     "                split-wx=on|off (enable TCG split w^x mapping)\n"
     "                tb-size=n (TCG translation block cache size)\n"
     "                dirty-ring-size=n (KVM dirty ring GFN count, default 0)\n"
@@ -221,6 +223,24 @@ SRST
         can be useful in some situations, such as when trying to analyse
         the logs produced by the ``-d`` option.
 
+    ``idle-warp=on|off``
+        When every vCPU is idle (for example halted in WFI), advance the
+        virtual clock straight to the next pending virtual timer deadline
+        instead of waiting for it in real time, much like ``-icount``
+        with ``sleep=off`` but without instruction counting. Guest time
+        then runs ahead of the host while the guest only sleeps, which
+        also applies when it is waiting for external input such as a
+        serial console. The option has no effect together with
+        ``-icount``, record/replay or qtest. The default is off.
+
+    ``poll-wait=on|off``
+        Detect a vCPU spinning on a status register of a device that
+        supports it, such as the S32K358 LPUART, PIT and FlexCAN, and
+        halt it until the device reports a change, an interrupt arrives
+        or a short virtual timeout expires. This saves host CPU time in
+        firmware that polls instead of waiting for interrupts. It has no
+        effect with record/replay. The default is off.
+
     ``split-wx=on|off``
         Controls the use of split w^x mapping for the TCG code generation
         buffer. Some operating systems require this to be enabled, and in
@@ -33,6 +33,7 @@
 #include "qemu/seqlock.h"
 #include "sysemu/replay.h"
 #include "sysemu/runstate.h"
+#include "sysemu/qtest.h"
 #include "hw/core/cpu.h"
 #include "sysemu/cpu-timers.h"
 #include "sysemu/cpu-timers-internal.h"
@@ -263,6 +264,37 @@ void qemu_timer_notify_cb(void *opaque, QEMUClockType type)
     }
 }
 
+bool idle_warp_enabled;
+
+void cpu_idle_warp(void)
+{
+    int64_t deadline;
+
+    if (!idle_warp_enabled || icount_enabled() ||
+        replay_mode != REPLAY_MODE_NONE || qtest_enabled() ||
+        !runstate_is_running() || !all_cpu_threads_idle()) {
+        return;
+    }
+
+    deadline = qemu_clock_deadline_ns_all(QEMU_CLOCK_VIRTUAL,
+                                          ~QEMU_TIMER_ATTR_EXTERNAL);
+    if (deadline <= 0) {
+        /* Nothing to wait for, or a timer is already due */
+        return;
+    }
+
+    /*
+     * Nothing can happen in the guest before the deadline: skip the
+     * time in between, as if the vCPUs had slept through it.
+     */
+    seqlock_write_lock(&timers_state.vm_clock_seqlock,
+                       &timers_state.vm_clock_lock);
+    timers_state.cpu_clock_offset += deadline;
+    seqlock_write_unlock(&timers_state.vm_clock_seqlock,
+                         &timers_state.vm_clock_lock);
+    qemu_clock_notify(QEMU_CLOCK_VIRTUAL);
+}
+
 TimersState timers_state;
 
 /* initialize timers state and the cpu throttle for convenience */
@@ -2412,6 +2412,11 @@ void memory_region_set_nonvolatile(MemoryRegion *mr, bool nonvolatile)
     }
 }
 
+void memory_region_set_wait_states(MemoryRegion *mr, uint8_t wait_states)
+{
+    mr->wait_states = wait_states;
+}
+
 void memory_region_rom_device_set_romd(MemoryRegion *mr, bool romd_mode)
 {
     if (mr->romd_mode != romd_mode) {
@@ -606,6 +606,14 @@ void qemu_system_guest_panicked(GuestPanicInformation *info)
                           S390CrashReason_str(info->u.s390.reason),
                           info->u.s390.psw_mask,
                           info->u.s390.psw_addr);
+        } else if (info->type == GUEST_PANIC_INFORMATION_TYPE_ARM_M) {
+            qemu_log_mask(LOG_GUEST_ERROR, ": dead loop at 0x%08" PRIx32 "\n"
+                          "xPSR: 0x%08" PRIx32 " CFSR: 0x%08" PRIx32
+                          " HFSR: 0x%08" PRIx32 "\n",
+                          info->u.arm_m.pc,
+                          info->u.arm_m.xpsr,
+                          info->u.arm_m.cfsr,
+                          info->u.arm_m.hfsr);
         }
         qapi_free_GuestPanicInformation(info);
     }
@@ -168,6 +168,15 @@ void arm_register_el_change_hook(ARMCPU *cpu, ARMELChangeHookFn *hook,
     QLIST_INSERT_HEAD(&cpu->el_change_hooks, entry, node);
 }
 
+void arm_register_m_watchpoint_hook(ARMCPU *cpu, ARMMWatchpointHookFn *hook,
+                                    void *opaque)
+{
+    assert(!cpu->m_watchpoint_hook);
+
+    cpu->m_watchpoint_hook = hook;
+    cpu->m_watchpoint_hook_opaque = opaque;
+}
+
 /*
  * Set the float_status behaviour to match the Arm defaults:
  *  * tininess-before-rounding
@@ -1583,6 +1592,12 @@ static Property arm_cpu_has_dsp_property =
 static Property arm_cpu_has_mpu_property =
             DEFINE_PROP_BOOL("has-mpu", ARMCPU, has_mpu, true);
 
+static Property arm_cpu_dead_loop_panic_property =
+            DEFINE_PROP_BOOL("dead-loop-panic", ARMCPU, dead_loop_panic, false);
+
+static Property arm_cpu_icount_cycles_property =
+            DEFINE_PROP_BOOL("icount-cycles", ARMCPU, icount_cycles, false);
+
 /* This is like DEFINE_PROP_UINT32 but it doesn't set the default value,
  * because the CPU initfn will have already set cpu->pmsav7_dregion to
  * the right value for that particular CPU type, and we don't want
@@ -1859,6 +1874,10 @@ void arm_cpu_post_init(Object *obj)
         object_property_add_uint32_ptr(obj, "init-nsvtor",
                                        &cpu->init_nsvtor,
                                        OBJ_PROP_FLAG_READWRITE);
+        qdev_property_add_static(DEVICE(obj),
+                                 &arm_cpu_dead_loop_panic_property);
+        qdev_property_add_static(DEVICE(obj),
+                                 &arm_cpu_icount_cycles_property);
     }
 
     /* Not DEFINE_PROP_UINT32: we want this to be settable after realize */
@@ -2658,8 +2677,29 @@ static const gchar *arm_gdb_arch_name(CPUState *cs)
 
 #ifndef CONFIG_USER_ONLY
 #include "hw/core/sysemu-cpu-ops.h"
+#include "qapi/qapi-types-run-state.h"
+
+static GuestPanicInformation *arm_cpu_get_crash_info(CPUState *cs)
+{
+    CPUARMState *env = cpu_env(cs);
+    GuestPanicInformation *panic_info;
+
+    if (!arm_feature(env, ARM_FEATURE_M)) {
+        return NULL;
+    }
+
+    panic_info = g_new0(GuestPanicInformation, 1);
+    panic_info->type = GUEST_PANIC_INFORMATION_TYPE_ARM_M;
+    panic_info->u.arm_m.pc = env->regs[15];
+    panic_info->u.arm_m.xpsr = xpsr_read(env);
+    panic_info->u.arm_m.cfsr = env->v7m.cfsr[env->v7m.secure];
+    panic_info->u.arm_m.hfsr = env->v7m.hfsr;
+
+    return panic_info;
+}
 
 static const struct SysemuCPUOps arm_sysemu_ops = {
+    .get_crash_info = arm_cpu_get_crash_info,
     .get_phys_page_attrs_debug = arm_cpu_get_phys_page_attrs_debug,
     .asidx_from_attrs = arm_asidx_from_attrs,
     .write_elf32_note = arm_cpu_write_elf32_note,
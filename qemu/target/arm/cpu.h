@@ -805,6 +805,30 @@ struct ARMELChangeHook {
     QLIST_ENTRY(ARMELChangeHook) node;
 };
 
+/**
+ * ARMMWatchpointHookFn:
+ * type of a function which can be registered via
+ * arm_register_m_watchpoint_hook() to get callbacks when a CPU
+ * watchpoint fires on an M-profile CPU.
+ */
+typedef void ARMMWatchpointHookFn(ARMCPU *cpu, CPUWatchpoint *wp,
+                                  void *opaque);
+
+/*
+ * M-profile hflags for one combination of security state, privilege,
+ * negative priority and handler mode, and the values of the rarely
+ * written registers they were computed from (see hflags.c).
+ */
+#define ARM_M_HFLAGS_CACHE_SIZE 16
+
+typedef struct ARMMHflagsCacheEntry {
+    bool valid;
+    uint32_t ccr;
+    uint32_t cpacr;
+    uint32_t nsacr;
+    CPUARMTBFlags flags;
+} ARMMHflagsCacheEntry;
+
 /* These values map onto the return values for
  * QEMU_PSCI_0_2_FN_AFFINITY_INFO */
 typedef enum ARMPSCIState {
@@ -940,6 +964,16 @@ struct ArchCPU {
     uint32_t init_svtor;
     /* For v8M, initial value of the Non-secure VTOR */
     uint32_t init_nsvtor;
+    /*
+     * M profile: report a branch-to-self in a handler or with interrupts
+     * masked (a crashed firmware's fault loop) as a guest panic
+     */
+    bool dead_loop_panic;
+    /*
+     * M profile: with -icount, charge each insn an approximation of its
+     * Cortex-M7 cycle cost rather than one
+     */
+    bool icount_cycles;
 
     /* [QEMU_]KVM_ARM_TARGET_* constant for this CPU, or
      * QEMU_KVM_ARM_TARGET_NONE if the kernel doesn't support this CPU type.
@@ -1087,6 +1121,13 @@ struct ArchCPU {
     QLIST_HEAD(, ARMELChangeHook) pre_el_change_hooks;
     QLIST_HEAD(, ARMELChangeHook) el_change_hooks;
 
+    /* M-profile watchpoint hook (the DWT owns all CPU watchpoints) */
+    ARMMWatchpointHookFn *m_watchpoint_hook;
+    void *m_watchpoint_hook_opaque;
+
+    /* Cache of M-profile hflags, indexed by execution state */
+    ARMMHflagsCacheEntry m_hflags_cache[ARM_M_HFLAGS_CACHE_SIZE];
+
     int32_t node_id; /* NUMA node this CPU belongs to */
 
     /* Used to synchronize KVM and QEMU in-kernel device levels */
@@ -3153,6 +3194,8 @@ FIELD(TBFLAG_M32, FPCCR_S_WRONG, 4, 1)          /* Not cached. */
 FIELD(TBFLAG_M32, MVE_NO_PRED, 5, 1)            /* Not cached. */
 /* Set if in secure mode */
 FIELD(TBFLAG_M32, SECURE, 6, 1)
+/* Set if any watchpoints are inserted */
+FIELD(TBFLAG_M32, WATCHPOINTS, 7, 1)            /* Not cached. */
 
 /*
  * Bit usage when in AArch64 state
@@ -3305,6 +3348,17 @@ void arm_register_pre_el_change_hook(ARMCPU *cpu, ARMELChangeHookFn *hook,
 void arm_register_el_change_hook(ARMCPU *cpu, ARMELChangeHookFn *hook, void
         *opaque);
 
+/**
+ * arm_register_m_watchpoint_hook:
+ * Register the hook function which will be called when a CPU watchpoint
+ * (BP_CPU) fires on this M-profile CPU. M-profile has no watchpoint
+ * registers in the CPU itself: such watchpoints are inserted by the
+ * DWT, which is told about the hit through this hook. The access then
+ * completes normally. Only one hook can be registered.
+ */
+void arm_register_m_watchpoint_hook(ARMCPU *cpu, ARMMWatchpointHookFn *hook,
+                                    void *opaque);
+
 /**
  * arm_rebuild_hflags:
  * Rebuild the cached TBFLAGS for arbitrary changed processor state.
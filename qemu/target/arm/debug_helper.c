@@ -428,6 +428,17 @@ bool arm_debug_check_watchpoint(CPUState *cs, CPUWatchpoint *wp)
      */
     ARMCPU *cpu = ARM_CPU(cs);
 
+    if (arm_feature(&cpu->env, ARM_FEATURE_M)) {
+        /*
+         * M-profile CPU watchpoints belong to the DWT, which only
+         * records the match: never take an exception for them.
+         */
+        if (cpu->m_watchpoint_hook) {
+            cpu->m_watchpoint_hook(cpu, wp, cpu->m_watchpoint_hook_opaque);
+        }
+        return false;
+    }
+
     return check_watchpoints(cpu);
 }
 
@@ -12714,6 +12714,10 @@ void cpu_get_tb_cpu_state(CPUARMState *env, vaddr *pc,
             if (mve_no_pred(env)) {
                 DP_TBFLAG_M32(flags, MVE_NO_PRED, 1);
             }
+
+            if (!QTAILQ_EMPTY(&env_cpu(env)->watchpoints)) {
+                DP_TBFLAG_M32(flags, WATCHPOINTS, 1);
+            }
         } else {
             /*
              * Note that XSCALE_CPAR shares bits with VECSTRIDE.
@@ -422,8 +422,58 @@ static CPUARMTBFlags rebuild_hflags_internal(CPUARMState *env)
     }
 }
 
+/*
+ * M-profile hflags are rebuilt on every exception entry and return and
+ * on writes to CONTROL, PRIMASK, BASEPRI and FAULTMASK, but these only
+ * change the security state, handler mode and the MMU index (privilege
+ * and negative priority). The other inputs are CCR, CPACR and NSACR,
+ * which firmware rarely writes after startup. So we keep the flags for
+ * each combination of the frequently changing state, and reuse them
+ * as long as the rarely written registers still match.
+ */
+static CPUARMTBFlags rebuild_hflags_m32_cached(CPUARMState *env)
+{
+    ARMCPU *cpu = env_archcpu(env);
+    bool secure = env->v7m.secure;
+    ARMMMUIdx mmu_idx = arm_v7m_mmu_idx_for_secstate(env, secure);
+    uint32_t ccr = env->v7m.ccr[secure];
+    uint32_t cpacr = env->v7m.cpacr[secure];
+    ARMMHflagsCacheEntry *e;
+    int key;
+
+    if (arm_singlestep_active(env)) {
+        /* Not part of the key; never the case for current M-profile CPUs */
+        int fp_el = fp_exception_el(env, arm_mmu_idx_to_el(mmu_idx));
+
+        return rebuild_hflags_m32(env, fp_el, mmu_idx);
+    }
+
+    key = mmu_idx & (ARM_MMU_IDX_M_PRIV | ARM_MMU_IDX_M_NEGPRI |
+                     ARM_MMU_IDX_M_S);
+    if (arm_v7m_is_handler_mode(env)) {
+        key |= 8;
+    }
+    e = &cpu->m_hflags_cache[key];
+
+    if (!e->valid || e->ccr != ccr || e->cpacr != cpacr ||
+        e->nsacr != env->v7m.nsacr) {
+        int fp_el = fp_exception_el(env, arm_mmu_idx_to_el(mmu_idx));
+
+        e->flags = rebuild_hflags_m32(env, fp_el, mmu_idx);
+        e->ccr = ccr;
+        e->cpacr = cpacr;
+        e->nsacr = env->v7m.nsacr;
+        e->valid = true;
+    }
+    return e->flags;
+}
+
 void arm_rebuild_hflags(CPUARMState *env)
 {
+    if (arm_feature(env, ARM_FEATURE_M)) {
+        env->hflags = rebuild_hflags_m32_cached(env);
+        return;
+    }
     env->hflags = rebuild_hflags_internal(env);
 }
 
@@ -433,19 +483,13 @@ void arm_rebuild_hflags(CPUARMState *env)
  */
 void HELPER(rebuild_hflags_m32_newel)(CPUARMState *env)
 {
-    int el = arm_current_el(env);
-    int fp_el = fp_exception_el(env, el);
-    ARMMMUIdx mmu_idx = arm_mmu_idx_el(env, el);
-
-    env->hflags = rebuild_hflags_m32(env, fp_el, mmu_idx);
+    env->hflags = rebuild_hflags_m32_cached(env);
 }
 
 void HELPER(rebuild_hflags_m32)(CPUARMState *env, int el)
 {
-    int fp_el = fp_exception_el(env, el);
-    ARMMMUIdx mmu_idx = arm_mmu_idx_el(env, el);
-
-    env->hflags = rebuild_hflags_m32(env, fp_el, mmu_idx);
+    /* The cache key includes the privilege level, so el isn't needed */
+    env->hflags = rebuild_hflags_m32_cached(env);
 }
 
 /*
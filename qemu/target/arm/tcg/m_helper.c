@@ -23,6 +23,8 @@
 #endif
 #if !defined(CONFIG_USER_ONLY)
 #include "hw/intc/armv7m_nvic.h"
+#include "sysemu/cpus.h"
+#include "sysemu/runstate.h"
 #endif
 
 static void v7m_msr_xpsr(CPUARMState *env, uint32_t mask,
@@ -133,6 +135,12 @@ void HELPER(v7m_vlldm)(CPUARMState *env, uint32_t fptr)
     g_assert_not_reached();
 }
 
+void HELPER(v7m_self_branch)(CPUARMState *env)
+{
+    /* translate.c should never generate calls here in user-only mode */
+    g_assert_not_reached();
+}
+
 uint32_t HELPER(v7m_tt)(CPUARMState *env, uint32_t addr, uint32_t op)
 {
     /*
@@ -356,6 +364,142 @@ pend_fault:
     return false;
 }
 
+/* Size of the basic (integer-only) exception stack frame */
+#define V7M_BASIC_FRAME_SIZE 0x20
+
+/*
+ * Check whether the basic exception frame at @addr can be transferred
+ * with a single memory access: the first and the last word must both
+ * pass the MPU/SAU checks with physically contiguous results (protection
+ * regions have a 32 byte granularity, so a 32 byte frame can overlap
+ * at most two of them), and the frame must be backed by RAM that we can
+ * access directly. On success fill in *@as, *@phys and *@attrs and
+ * return true. On failure return false without recording any fault
+ * state; the caller then goes word by word, which reports faults
+ * precisely.
+ */
+static bool v7m_stack_frame_direct(ARMCPU *cpu, uint32_t addr,
+                                   ARMMMUIdx mmu_idx,
+                                   MMUAccessType access_type,
+                                   AddressSpace **as, hwaddr *phys,
+                                   MemTxAttrs *attrs)
+{
+    CPUARMState *env = &cpu->env;
+    GetPhysAddrResult res = {};
+    GetPhysAddrResult res_last = {};
+    ARMMMUFaultInfo fi = {};
+    bool is_write = access_type == MMU_DATA_STORE;
+    MemoryRegion *mr;
+    hwaddr xlat, len = V7M_BASIC_FRAME_SIZE;
+
+    if (get_phys_addr(env, addr, access_type, 0, mmu_idx, &res, &fi) ||
+        get_phys_addr(env, addr + V7M_BASIC_FRAME_SIZE - 4, access_type, 0,
+                      mmu_idx, &res_last, &fi)) {
+        return false;
+    }
+    if (res_last.f.phys_addr != res.f.phys_addr + V7M_BASIC_FRAME_SIZE - 4 ||
+        res_last.f.attrs.secure != res.f.attrs.secure) {
+        return false;
+    }
+
+    *as = arm_addressspace(CPU(cpu), res.f.attrs);
+    *phys = res.f.phys_addr;
+    *attrs = res.f.attrs;
+
+    RCU_READ_LOCK_GUARD();
+    mr = address_space_translate(*as, *phys, &xlat, &len, is_write, *attrs);
+    return len >= V7M_BASIC_FRAME_SIZE && memory_access_is_direct(mr, is_write);
+}
+
+/*
+ * Push the basic exception frame (R0-R3, R12, LR, ReturnAddress, xPSR)
+ * at @frameptr. In the common case of a stack in plain RAM the frame
+ * is stored with a single access; otherwise we fall back to
+ * v7m_stack_write() for each word. Returns false if a stack write
+ * failed and a derived exception was pended.
+ */
+static bool v7m_push_basic_frame(ARMCPU *cpu, uint32_t frameptr,
+                                 uint32_t xpsr, ARMMMUIdx mmu_idx)
+{
+    CPUARMState *env = &cpu->env;
+    uint32_t frame[V7M_BASIC_FRAME_SIZE / 4];
+    AddressSpace *as;
+    hwaddr phys;
+    MemTxAttrs attrs;
+
+    if (v7m_stack_frame_direct(cpu, frameptr, mmu_idx, MMU_DATA_STORE,
+                               &as, &phys, &attrs)) {
+        stl_le_p(&frame[0], env->regs[0]);
+        stl_le_p(&frame[1], env->regs[1]);
+        stl_le_p(&frame[2], env->regs[2]);
+        stl_le_p(&frame[3], env->regs[3]);
+        stl_le_p(&frame[4], env->regs[12]);
+        stl_le_p(&frame[5], env->regs[14]);
+        stl_le_p(&frame[6], env->regs[15]);
+        stl_le_p(&frame[7], xpsr);
+        if (address_space_write(as, phys, attrs, frame,
+                                V7M_BASIC_FRAME_SIZE) == MEMTX_OK) {
+            return true;
+        }
+    }
+
+    return v7m_stack_write(cpu, frameptr, env->regs[0],
+                           mmu_idx, STACK_NORMAL) &&
+        v7m_stack_write(cpu, frameptr + 4, env->regs[1],
+                        mmu_idx, STACK_NORMAL) &&
+        v7m_stack_write(cpu, frameptr + 8, env->regs[2],
+                        mmu_idx, STACK_NORMAL) &&
+        v7m_stack_write(cpu, frameptr + 12, env->regs[3],
+                        mmu_idx, STACK_NORMAL) &&
+        v7m_stack_write(cpu, frameptr + 16, env->regs[12],
+                        mmu_idx, STACK_NORMAL) &&
+        v7m_stack_write(cpu, frameptr + 20, env->regs[14],
+                        mmu_idx, STACK_NORMAL) &&
+        v7m_stack_write(cpu, frameptr + 24, env->regs[15],
+                        mmu_idx, STACK_NORMAL) &&
+        v7m_stack_write(cpu, frameptr + 28, xpsr, mmu_idx, STACK_NORMAL);
+}
+
+/*
+ * Pop the basic exception frame at @frameptr into R0-R3, R12, LR, PC
+ * and *@xpsr, with the same single-access fast path as
+ * v7m_push_basic_frame(). Returns false if a stack read failed and a
+ * derived exception was pended.
+ */
+static bool v7m_pop_basic_frame(ARMCPU *cpu, uint32_t frameptr,
+                                uint32_t *xpsr, ARMMMUIdx mmu_idx)
+{
+    CPUARMState *env = &cpu->env;
+    uint32_t frame[V7M_BASIC_FRAME_SIZE / 4];
+    AddressSpace *as;
+    hwaddr phys;
+    MemTxAttrs attrs;
+
+    if (v7m_stack_frame_direct(cpu, frameptr, mmu_idx, MMU_DATA_LOAD,
+                               &as, &phys, &attrs) &&
+        address_space_read(as, phys, attrs, frame,
+                           V7M_BASIC_FRAME_SIZE) == MEMTX_OK) {
+        env->regs[0] = ldl_le_p(&frame[0]);
+        env->regs[1] = ldl_le_p(&frame[1]);
+        env->regs[2] = ldl_le_p(&frame[2]);
+        env->regs[3] = ldl_le_p(&frame[3]);
+        env->regs[12] = ldl_le_p(&frame[4]);
+        env->regs[14] = ldl_le_p(&frame[5]);
+        env->regs[15] = ldl_le_p(&frame[6]);
+        *xpsr = ldl_le_p(&frame[7]);
+        return true;
+    }
+
+    return v7m_stack_read(cpu, &env->regs[0], frameptr, mmu_idx) &&
+        v7m_stack_read(cpu, &env->regs[1], frameptr + 0x4, mmu_idx) &&
+        v7m_stack_read(cpu, &env->regs[2], frameptr + 0x8, mmu_idx) &&
+        v7m_stack_read(cpu, &env->regs[3], frameptr + 0xc, mmu_idx) &&
+        v7m_stack_read(cpu, &env->regs[12], frameptr + 0x10, mmu_idx) &&
+        v7m_stack_read(cpu, &env->regs[14], frameptr + 0x14, mmu_idx) &&
+        v7m_stack_read(cpu, &env->regs[15], frameptr + 0x18, mmu_idx) &&
+        v7m_stack_read(cpu, xpsr, frameptr + 0x1c, mmu_idx);
+}
+
 void HELPER(v7m_preserve_fp_state)(CPUARMState *env)
 {
     /*
@@ -1172,6 +1316,70 @@ void HELPER(v7m_vlldm)(CPUARMState *env, uint32_t fptr)
     env->v7m.control[M_REG_S] |= R_V7M_CONTROL_FPCA_MASK;
 }
 
+/*
+ * True if a branch-to-self at this point means the firmware is stuck
+ * rather than idle: it is in a handler (such as the fault handler a
+ * crashed firmware ends up in), or it has masked some or all interrupts
+ * with PRIMASK, FAULTMASK or BASEPRI (as FreeRTOS's configASSERT does).
+ */
+static bool v7m_is_dead_loop(CPUARMState *env)
+{
+    bool secure = env->v7m.secure;
+
+    return arm_v7m_is_handler_mode(env) ||
+        (env->v7m.primask[secure] & 1) ||
+        (env->v7m.faultmask[secure] & 1) ||
+        env->v7m.basepri[secure] != 0;
+}
+
+void HELPER(v7m_self_branch)(CPUARMState *env)
+{
+    /*
+     * The guest is executing a branch to itself, which it can only leave
+     * by taking an exception: halt as if for WFI rather than spinning.
+     * translate.c has already set the PC to the branch, so that is
+     * where we resume, and halt again, after any exception returns.
+     */
+    CPUState *cs = env_cpu(env);
+    bool masked_pending;
+
+    if (armv7m_nvic_can_take_pending_exception(env->nvic)) {
+        /* An exception is ready to be taken: let the loop take it */
+        return;
+    }
+
+    /*
+     * The NVIC output ignores PRIMASK, FAULTMASK and BASEPRI, so with an
+     * exception pending behind them a halted CPU would wake straight
+     * away. An exception of higher priority than the mask, or an NMI,
+     * can still arrive and be taken, so the loop is not necessarily dead.
+     */
+    masked_pending = cs->interrupt_request & CPU_INTERRUPT_HARD;
+
+    if (env_archcpu(env)->dead_loop_panic && v7m_is_dead_loop(env)) {
+        bql_lock();
+        qemu_system_guest_panicked(cpu_get_crash_info(cs));
+        bql_unlock();
+
+        if (masked_pending) {
+            /*
+             * We cannot halt, and returning would report the panic
+             * again on every iteration: stop this vCPU until the VM is
+             * next resumed.
+             */
+            cpu_stop_current();
+            cpu_loop_exit(cs);
+        }
+    } else if (masked_pending) {
+        /* Keep executing the loop until something we can take arrives */
+        return;
+    }
+
+    cs->exception_index = EXCP_HLT;
+    cs->halted = 1;
+    cpu_loop_exit(cs);
+}
+
 static bool v7m_push_stack(ARMCPU *cpu)
 {
     /*
@@ -1250,20 +1458,7 @@ static bool v7m_push_stack(ARMCPU *cpu)
      * if it has higher priority).
      */
     stacked_ok = stacked_ok &&
-        v7m_stack_write(cpu, frameptr, env->regs[0], mmu_idx, STACK_NORMAL) &&
-        v7m_stack_write(cpu, frameptr + 4, env->regs[1],
-                        mmu_idx, STACK_NORMAL) &&
-        v7m_stack_write(cpu, frameptr + 8, env->regs[2],
-                        mmu_idx, STACK_NORMAL) &&
-        v7m_stack_write(cpu, frameptr + 12, env->regs[3],
-                        mmu_idx, STACK_NORMAL) &&
-        v7m_stack_write(cpu, frameptr + 16, env->regs[12],
-                        mmu_idx, STACK_NORMAL) &&
-        v7m_stack_write(cpu, frameptr + 20, env->regs[14],
-                        mmu_idx, STACK_NORMAL) &&
-        v7m_stack_write(cpu, frameptr + 24, env->regs[15],
-                        mmu_idx, STACK_NORMAL) &&
-        v7m_stack_write(cpu, frameptr + 28, xpsr, mmu_idx, STACK_NORMAL);
+        v7m_push_basic_frame(cpu, frameptr, xpsr, mmu_idx);
 
     if (env->v7m.control[M_REG_S] & R_V7M_CONTROL_FPCA_MASK) {
         /* FPU is active, try to save its registers */
@@ -1675,14 +1870,7 @@ static void do_v7m_exception_exit(ARMCPU *cpu)
 
         /* Pop registers */
         pop_ok = pop_ok &&
-            v7m_stack_read(cpu, &env->regs[0], frameptr, mmu_idx) &&
-            v7m_stack_read(cpu, &env->regs[1], frameptr + 0x4, mmu_idx) &&
-            v7m_stack_read(cpu, &env->regs[2], frameptr + 0x8, mmu_idx) &&
-            v7m_stack_read(cpu, &env->regs[3], frameptr + 0xc, mmu_idx) &&
-            v7m_stack_read(cpu, &env->regs[12], frameptr + 0x10, mmu_idx) &&
-            v7m_stack_read(cpu, &env->regs[14], frameptr + 0x14, mmu_idx) &&
-            v7m_stack_read(cpu, &env->regs[15], frameptr + 0x18, mmu_idx) &&
-            v7m_stack_read(cpu, &xpsr, frameptr + 0x1c, mmu_idx);
+            v7m_pop_basic_frame(cpu, frameptr, &xpsr, mmu_idx);
 
         if (!pop_ok) {
             /*
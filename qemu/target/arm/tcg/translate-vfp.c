@@ -2009,11 +2009,13 @@ static bool trans_VDIV_hp(DisasContext *s, arg_VDIV_sp *a)
 
 static bool trans_VDIV_sp(DisasContext *s, arg_VDIV_sp *a)
 {
+    arm_icount_cycles(s, M7_CYCLES_VDIV_SP);
     return do_vfp_3op_sp(s, gen_helper_vfp_divs, a->vd, a->vn, a->vm, false);
 }
 
 static bool trans_VDIV_dp(DisasContext *s, arg_VDIV_dp *a)
 {
+    arm_icount_cycles(s, M7_CYCLES_VDIV_DP);
     return do_vfp_3op_dp(s, gen_helper_vfp_divd, a->vd, a->vn, a->vm, false);
 }
 
@@ -2438,8 +2440,24 @@ static void gen_VSQRT_dp(TCGv_i64 vd, TCGv_i64 vm)
 }
 
 DO_VFP_2OP(VSQRT, hp, gen_VSQRT_hp, aa32_fp16_arith)
-DO_VFP_2OP(VSQRT, sp, gen_VSQRT_sp, aa32_fpsp_v2)
-DO_VFP_2OP(VSQRT, dp, gen_VSQRT_dp, aa32_fpdp_v2)
+
+static bool trans_VSQRT_sp(DisasContext *s, arg_VSQRT_sp *a)
+{
+    if (!dc_isar_feature(aa32_fpsp_v2, s)) {
+        return false;
+    }
+    arm_icount_cycles(s, M7_CYCLES_VDIV_SP);
+    return do_vfp_2op_sp(s, gen_VSQRT_sp, a->vd, a->vm);
+}
+
+static bool trans_VSQRT_dp(DisasContext *s, arg_VSQRT_dp *a)
+{
+    if (!dc_isar_feature(aa32_fpdp_v2, s)) {
+        return false;
+    }
+    arm_icount_cycles(s, M7_CYCLES_VDIV_DP);
+    return do_vfp_2op_dp(s, gen_VSQRT_dp, a->vd, a->vm);
+}
 
 static bool trans_VCMP_hp(DisasContext *s, arg_VCMP_sp *a)
 {
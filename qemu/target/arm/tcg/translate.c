@@ -272,6 +272,9 @@ static void gen_pc_plus_diff(DisasContext *s, TCGv_i32 var, target_long diff)
 /* Set a variable to the value of a CPU register.  */
 void load_reg_var(DisasContext *s, TCGv_i32 var, int reg)
 {
+    if (reg == s->load_use_reg) {
+        s->insn_load_use = true;
+    }
     if (reg == 15) {
         gen_pc_plus_diff(s, var, jmp_diff(s, 0));
     } else {
@@ -288,6 +291,9 @@ TCGv_i32 add_reg_for_lit(DisasContext *s, int reg, int ofs)
 {
     TCGv_i32 tmp = tcg_temp_new_i32();
 
+    if (reg == s->load_use_reg) {
+        s->insn_load_use = true;
+    }
     if (reg == 15) {
         /*
          * This address is computed from an aligned PC:
@@ -890,6 +896,7 @@ static inline void store_reg_from_load(DisasContext *s, int reg, TCGv_i32 var)
         gen_bx_excret(s, var);
     } else {
         store_reg(s, reg, var);
+        s->insn_load_reg = reg;
     }
 }
 
@@ -2603,6 +2610,32 @@ static inline void gen_jmp(DisasContext *s, target_long diff)
     gen_jmp_tb(s, diff, 0);
 }
 
+/*
+ * Unconditional direct branch to pc_curr + diff. If the destination is
+ * further on in the (host-backed) page this Thumb TB started in, carry
+ * on translating there instead of ending the TB, so that code laid out
+ * with forward branches (if/else joins, loop entries, calls to nearby
+ * functions) runs as one TB rather than a chain of short ones. Skipped
+ * bytes are still part of the TB's range, so writing to them just
+ * invalidates it a little more eagerly than needed. Going backwards
+ * would need a new interrupt check per iteration: loops are left to TB
+ * chaining.
+ */
+static void gen_jmp_follow(DisasContext *s, target_long diff)
+{
+    vaddr dest = s->pc_curr + diff;
+
+    if (s->thumb && s->base.is_jmp == DISAS_NEXT &&
+        !s->ss_active && !s->condexec_mask && !s->eci &&
+        s->base.host_addr[0] &&
+        dest >= s->base.pc_next &&
+        ((dest ^ s->base.pc_first) & TARGET_PAGE_MASK) == 0) {
+        s->base.pc_next = dest;
+        return;
+    }
+    gen_jmp(s, diff);
+}
+
 static inline void gen_mulxy(TCGv_i32 t0, TCGv_i32 t1, int x, int y)
 {
     if (x)
@@ -4698,6 +4731,7 @@ static bool trans_BX(DisasContext *s, arg_BX *a)
     if (!ENABLE_ARCH_4T) {
         return false;
     }
+    arm_icount_cycles(s, M7_CYCLES_BRANCH_REG);
     gen_bx_excret(s, load_reg(s, a->rm));
     return true;
 }
@@ -4731,6 +4765,7 @@ static bool trans_BLX_r(DisasContext *s, arg_BLX_r *a)
     if (!ENABLE_ARCH_5) {
         return false;
     }
+    arm_icount_cycles(s, M7_CYCLES_BRANCH_REG);
     tmp = load_reg(s, a->rm);
     gen_pc_plus_diff(s, cpu_R[14], curr_insn_len(s) | s->thumb);
     gen_bx(s, tmp);
@@ -5105,11 +5140,60 @@ static void op_addr_ri_post(DisasContext *s, arg_ldst_ri *a,
     store_reg(s, a->rn, addr);
 }
 
+/*
+ * Try to do an M-profile LDR (literal) at translate time, returning
+ * true and the loaded word in *val if we can.
+ *
+ * This is only done when the literal is in the same guest page as the
+ * start of the TB and that page is read-only ROM. A TB is only created
+ * with host_addr[0] set when a single MPU/SAU region covers the whole
+ * page, and PMSA never grants execute without read, so the load could
+ * not fault. The ROM check matters because a write to a literal in RAM
+ * would only invalidate TBs whose own code it overlaps, leaving a stale
+ * constant in this one. Watchpoints on the literal are honoured by not
+ * folding while any are inserted, which is part of the TB flags.
+ */
+static bool fold_literal_load(DisasContext *s, arg_ldst_ri *a,
+                              MemOp mop, int mem_idx, uint32_t *val)
+{
+    vaddr pc_first = s->base.pc_first;
+    int ofs = a->u ? a->imm : -a->imm;
+    vaddr addr;
+
+    if (!s->fold_literals || s->base.plugin_enabled ||
+        !s->base.host_addr[0] ||
+        a->rn != 15 || !a->p || a->w ||
+        mop != MO_UL || mem_idx != get_mem_index(s)) {
+        return false;
+    }
+
+    /* As for add_reg_for_lit(); M-profile is always Thumb */
+    addr = (s->pc_curr & ~3) + 4 + ofs;
+    if ((addr & 3) || ((addr ^ pc_first) & TARGET_PAGE_MASK)) {
+        return false;
+    }
+
+    *val = ldl_le_p(s->base.host_addr[0] + (addr - pc_first));
+    return true;
+}
+
 static bool op_load_ri(DisasContext *s, arg_ldst_ri *a,
                        MemOp mop, int mem_idx)
 {
     ISSInfo issinfo = make_issinfo(s, a->rt, a->p, a->w);
     TCGv_i32 addr, tmp;
+    uint32_t val;
+
+    if (a->rn == 15) {
+        /* A literal load reads the code memory */
+        s->insn_stall = s->fetch_wait_states;
+    }
+    if (fold_literal_load(s, a, mop, mem_idx, &val)) {
+        tmp = tcg_temp_new_i32();
+        tcg_gen_movi_i32(tmp, val);
+        store_reg_from_load(s, a->rt, tmp);
+        return true;
+    }
 
     addr = op_addr_ri_pre(s, a);
 
@@ -6216,6 +6300,7 @@ static bool op_div(DisasContext *s, arg_rrr *a, bool u)
         return false;
     }
 
+    arm_icount_cycles(s, M7_CYCLES_DIV);
     t1 = load_reg(s, a->rn);
     t2 = load_reg(s, a->rm);
     if (u) {
@@ -6326,6 +6411,9 @@ static bool op_stm(DisasContext *s, arg_ldst_block *a)
         return true;
     }
 
+    /* Two registers per cycle over the 64-bit bus */
+    arm_icount_cycles(s, 1 + (n + 1) / 2);
+
     s->eci_handled = true;
 
     addr = op_addr_block_pre(s, a, n);
@@ -6411,6 +6499,8 @@ static bool do_ldm(DisasContext *s, arg_ldst_block *a)
         return true;
     }
 
+    arm_icount_cycles(s, 1 + (n + 1) / 2);
+
     s->eci_handled = true;
 
     addr = op_addr_block_pre(s, a, n);
@@ -6536,7 +6626,21 @@ static bool trans_CLRM(DisasContext *s, arg_CLRM *a)
 
 static bool trans_B(DisasContext *s, arg_i *a)
 {
-    gen_jmp(s, jmp_diff(s, a->imm));
+    arm_icount_cycles(s, M7_CYCLES_BRANCH);
+    /*
+     * An M-profile "b ." (idle loop, or a crashed firmware's fault loop)
+     * can only be left by an exception: halt in the helper rather than
+     * spinning, and go round again if it returns.
+     */
+    if (!IS_USER_ONLY && arm_dc_feature(s, ARM_FEATURE_M) &&
+        jmp_diff(s, a->imm) == 0 && !s->condexec_mask && !s->ss_active &&
+        !(tb_cflags(s->base.tb) & CF_SINGLE_STEP)) {
+        gen_update_pc(s, 0);
+        gen_helper_v7m_self_branch(tcg_env);
+        gen_jmp(s, 0);
+        return true;
+    }
+    gen_jmp_follow(s, jmp_diff(s, a->imm));
     return true;
 }
 
@@ -6557,8 +6661,9 @@ static bool trans_B_cond_thumb(DisasContext *s, arg_ci *a)
 
 static bool trans_BL(DisasContext *s, arg_i *a)
 {
+    arm_icount_cycles(s, M7_CYCLES_BRANCH);
     gen_pc_plus_diff(s, cpu_R[14], curr_insn_len(s) | s->thumb);
-    gen_jmp(s, jmp_diff(s, a->imm));
+    gen_jmp_follow(s, jmp_diff(s, a->imm));
     return true;
 }
 
@@ -7570,6 +7675,8 @@ static void arm_tr_init_disas_context(DisasContextBase *dcbase, CPUState *cs)
             EX_TBFLAG_M32(tb_flags, NEW_FP_CTXT_NEEDED);
         dc->v7m_lspact = EX_TBFLAG_M32(tb_flags, LSPACT);
         dc->mve_no_pred = EX_TBFLAG_M32(tb_flags, MVE_NO_PRED);
+        dc->icount_cycles = cpu->icount_cycles &&
+                            (tb_cflags(dc->base.tb) & CF_USE_ICOUNT);
     } else {
         dc->sctlr_b = EX_TBFLAG_A32(tb_flags, SCTLR__B);
         dc->hstr_active = EX_TBFLAG_A32(tb_flags, HSTR_ACTIVE);
@@ -7584,6 +7691,21 @@ static void arm_tr_init_disas_context(DisasContextBase *dcbase, CPUState *cs)
         dc->sme_trap_nonstreaming =
             EX_TBFLAG_A32(tb_flags, SME_TRAP_NONSTREAMING);
     }
+    dc->load_use_reg = dc->insn_load_reg = -1;
+    dc->fetch_line = -1;
+#ifndef CONFIG_USER_ONLY
+    if (arm_feature(env, ARM_FEATURE_M) && dc->base.host_addr[0]) {
+        ram_addr_t offset;
+        MemoryRegion *mr = memory_region_from_host(dc->base.host_addr[0],
+                                                   &offset);
+
+        dc->fold_literals = mr && memory_region_is_rom(mr) &&
+                            !EX_TBFLAG_M32(tb_flags, WATCHPOINTS);
+        if (mr && dc->icount_cycles) {
+            dc->fetch_wait_states = memory_region_get_wait_states(mr);
+        }
+    }
+#endif
     dc->lse2 = false; /* applies only to aarch64 */
     dc->cp_regs = cpu->cp_regs;
     dc->features = env->features;
@@ -7828,6 +7950,40 @@ static bool thumb_insn_is_unconditional(DisasContext *s, uint32_t insn)
     return false;
 }
 
+/*
+ * Set the icount cost of the insn just translated, for "icount-cycles".
+ * This is a rough model of the Cortex-M7 pipeline: the insn's cycles
+ * from arm_icount_cycles() or else one cycle, shared with the previous
+ * insn if that left its second issue slot free; plus a stall if it uses
+ * the result of the load just before it, and the fetch wait states of
+ * each new 64-bit line of code.
+ */
+static void arm_icount_account(DisasContext *dc)
+{
+    vaddr line = (dc->base.pc_next - 1) >> 3;
+    int cost;
+
+    if (dc->insn_cycles) {
+        cost = dc->insn_cycles;
+        dc->dual_issue_slot = false;
+    } else if (dc->dual_issue_slot) {
+        cost = 0;
+        dc->dual_issue_slot = false;
+    } else {
+        cost = 1;
+        dc->dual_issue_slot = true;
+    }
+    if (dc->insn_load_use) {
+        cost += M7_CYCLES_LOAD_USE;
+    }
+    if (line != dc->fetch_line) {
+        cost += dc->fetch_wait_states;
+        dc->fetch_line = line;
+    }
+    dc->base.insn_cost = cost + dc->insn_stall;
+    dc->load_use_reg = dc->insn_load_reg;
+}
+
 static void thumb_tr_translate_insn(DisasContextBase *dcbase, CPUState *cpu)
 {
     DisasContext *dc = container_of(dcbase, DisasContext, base);
@@ -7915,6 +8071,11 @@ static void thumb_tr_translate_insn(DisasContextBase *dcbase, CPUState *cpu)
         }
     }
 
+    dc->insn_cycles = 0;
+    dc->insn_stall = 0;
+    dc->insn_load_use = false;
+    dc->insn_load_reg = -1;
+
     if (is_16bit) {
         disas_thumb_insn(dc, insn);
     } else {
@@ -7942,6 +8103,10 @@ static void thumb_tr_translate_insn(DisasContextBase *dcbase, CPUState *cpu)
         gen_exception_insn(dc, 0, EXCP_INVSTATE, syn_uncategorized());
     }
 
+    if (dc->icount_cycles) {
+        arm_icount_account(dc);
+    }
+
     arm_post_translate_insn(dc);
 
     /* Thumb is a variable-length ISA.  Stop translation when the next insn
@@ -136,6 +136,31 @@ typedef struct DisasContext {
     bool is_nonstreaming;
     /* True if MVE insns are definitely not predicated by VPR or LTPSIZE */
     bool mve_no_pred;
+    /*
+     * True if word literal loads from the first page of the TB may be
+     * done at translate time (M-profile code in ROM, no watchpoints)
+     */
+    bool fold_literals;
+    /*
+     * True if insns are charged their approximate Cortex-M7 cycle cost
+     * for icount (M-profile "icount-cycles"): see arm_icount_account()
+     */
+    bool icount_cycles;
+    /* Wait states of the memory this TB's code is fetched from */
+    uint8_t fetch_wait_states;
+    /* True if the previous insn left the second issue slot free */
+    bool dual_issue_slot;
+    /* Cycles for the current insn if it cannot dual-issue, else 0 */
+    uint8_t insn_cycles;
+    /* Wait state cycles for the current insn's literal load */
+    uint8_t insn_stall;
+    /* True if the current insn reads the register load_use_reg */
+    bool insn_load_use;
+    /* Register loaded by the previous insn and by this one, or -1 */
+    int8_t load_use_reg;
+    int8_t insn_load_reg;
+    /* Last 64-bit code line charged fetch wait states, or -1 */
+    vaddr fetch_line;
     /* True if fine-grained traps are active */
     bool fgt_active;
     /* True if fine-grained trap on SVC is enabled */
@@ -171,6 +196,25 @@ typedef struct DisasContext {
     uint32_t nv2_redirect_offset;
 } DisasContext;
 
+/*
+ * Approximate Cortex-M7 cycle counts for "icount-cycles".  Insns not
+ * listed take one cycle and may dual-issue with a neighbour; branch
+ * prediction, the FPU pipeline and data-side wait states are not
+ * modelled.
+ */
+#define M7_CYCLES_BRANCH        2   /* B, BL */
+#define M7_CYCLES_BRANCH_REG    4   /* BX, BLX: pipeline refill */
+#define M7_CYCLES_DIV           8   /* UDIV, SDIV: 2..12 by operands */
+#define M7_CYCLES_VDIV_SP       14  /* VDIV.F32, VSQRT.F32 */
+#define M7_CYCLES_VDIV_DP       30  /* VDIV.F64, VSQRT.F64 */
+#define M7_CYCLES_LOAD_USE      1   /* using a value loaded just before */
+
+/* Charge the current insn CYCLES cycles, without dual issue */
+static inline void arm_icount_cycles(DisasContext *s, int cycles)
+{
+    s->insn_cycles = cycles;
+}
+
 typedef struct DisasCompare {
     TCGCond cond;
     TCGv_i32 value;
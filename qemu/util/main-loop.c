@@ -582,6 +582,12 @@ void main_loop_wait(int nonblocking)
         timeout_ns = (uint64_t)mlpoll.timeout * (int64_t)(SCALE_MS);
     }
 
+    /*
+     * With idle warp, if the vCPUs are all idle, skip QEMU_CLOCK_VIRTUAL
+     * ahead to its next deadline so that we don't sleep until it.
+     */
+    cpu_idle_warp();
+
     timeout_ns = qemu_soonest_timeout(timeout_ns,
                                       timerlistgroup_deadline_ns(
                                           &main_loop_tlg));